@@ -0,0 +1,93 @@
+#include "mini_json.h"
+#include <assert.h>     /* assert() */
+#include <errno.h>      /* errno, EINTR */
+#include <fcntl.h>      /* open() */
+#include <sys/mman.h>   /* mmap(), madvise(), munmap() */
+#include <sys/stat.h>   /* fstat() */
+#include <unistd.h>     /* close(), write() */
+
+/* the whole file read-only, an empty one maps to NULL */
+static int mini_map_file(const char* path, const char** data, size_t* len) {
+    struct stat st;
+    void* p = NULL;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    *len = (size_t)st.st_size;
+    if (*len != 0) {
+        if ((p = mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        /* read once front to back: aggressive read-ahead, pages dropped behind */
+        madvise(p, *len, MADV_SEQUENTIAL);
+    }
+    close(fd);  /* the mapping outlives the descriptor */
+    *data = (const char*)p;
+    return 0;
+}
+
+static void mini_unmap_file(const char* data, size_t len) {
+    if (len != 0)
+        munmap((void*)data, len);
+}
+
+int mini_parse_file(mini_value* v, const char* path) {
+    const char* data;
+    size_t len;
+    int ret;
+    assert(v != NULL && path != NULL);
+    if (mini_map_file(path, &data, &len) != 0) {
+        mini_init(v);
+        return MINI_PARSE_FILE_ERROR;
+    }
+    ret = mini_parse_len(v, data, len);
+    mini_unmap_file(data, len);
+    return ret;
+}
+
+int mini_parse_document_file(mini_document* doc, const char* path) {
+    const char* data;
+    size_t len;
+    int ret;
+    assert(doc != NULL && path != NULL);
+    if (mini_map_file(path, &data, &len) != 0) {
+        arena_init(&doc->arena);
+        mini_init(&doc->root);
+        doc->marks = NULL;
+        doc->nmarks = 0;
+        return MINI_PARSE_FILE_ERROR;
+    }
+    ret = mini_parse_document_len(doc, data, len);
+    mini_unmap_file(data, len);
+    return ret;
+}
+
+int mini_fd_sink(void* fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(*(const int*)fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int mini_generate_file(const mini_value* v, const char* path) {
+    int fd, ret;
+    assert(v != NULL && path != NULL);
+    if ((fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0)
+        return MINI_GENERATE_SINK_ERROR;
+    ret = mini_generate_to(v, mini_fd_sink, &fd);
+    if (close(fd) != 0 && ret == MINI_GENERATE_OK)
+        ret = MINI_GENERATE_SINK_ERROR;
+    return ret;
+}
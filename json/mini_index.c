@@ -0,0 +1,180 @@
+#include "mini_index.h"
+#include <stdlib.h>  /* malloc(), realloc() */
+#include <string.h>  /* memcpy(), memset() */
+
+#define MINI_ODD_BITS 0xAAAAAAAAAAAAAAAAull
+
+/* one 64-byte block, a bit per byte; control holds the bytes below 0x20 */
+typedef struct {
+    uint64_t whitespace, op, quote, backslash, control;
+}mini_block;
+
+static void mini_classify_scalar(const char* p, mini_block* b) {
+    int i;
+    b->whitespace = b->op = b->quote = b->backslash = b->control = 0;
+    for (i = 0; i < 64; i++) {
+        uint64_t bit = 1ull << i;
+        if ((unsigned char)p[i] < 0x20)
+            b->control |= bit;
+        switch (p[i]) {
+            case ' ': case '\t': case '\n': case '\r':
+                b->whitespace |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',':
+                b->op |= bit; break;
+            case '\"': b->quote |= bit; break;
+            case '\\': b->backslash |= bit; break;
+            default: break;
+        }
+    }
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+
+#define MINI_SIMD(isa) __attribute__((target(isa)))
+
+MINI_SIMD("sse2")
+static void mini_classify_sse2(const char* p, mini_block* b) {
+    int i;
+    __m128i ctrl = _mm_set1_epi8(0x1F);
+    b->whitespace = b->op = b->quote = b->backslash = b->control = 0;
+    for (i = 0; i < 64; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(p + i));
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(x, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(x, _mm_set1_epi8('\r'))));
+        /* '[' ']' and '{' '}' differ only in 0x20 */
+        __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+        __m128i op = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('{')), _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'))),
+            _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(':')), _mm_cmpeq_epi8(x, _mm_set1_epi8(','))));
+        b->whitespace |= (uint64_t)(unsigned int)_mm_movemask_epi8(ws) << i;
+        b->op |= (uint64_t)(unsigned int)_mm_movemask_epi8(op) << i;
+        b->quote |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8('\"'))) << i;
+        b->backslash |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8('\\'))) << i;
+        b->control |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(x, ctrl), ctrl)) << i;
+    }
+}
+
+/*
+ * whitespace and operators by their two nibbles: a byte is in a class when
+ * both nibble tables have the class bit. The bits: 1 tab, newline and
+ * carriage return, 2 space, 4 ',', 8 ':', 16 the brackets.
+ */
+MINI_SIMD("avx2")
+static void mini_classify_avx2(const char* p, mini_block* b) {
+    const __m256i low = _mm256_setr_epi8(
+        2, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1 | 8, 16, 4, 1 | 16, 0, 0,
+        2, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1 | 8, 16, 4, 1 | 16, 0, 0);
+    const __m256i high = _mm256_setr_epi8(
+        1, 0, 2 | 4, 8, 0, 16, 0, 16, 0, 0, 0, 0, 0, 0, 0, 0,
+        1, 0, 2 | 4, 8, 0, 16, 0, 16, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i nibble = _mm256_set1_epi8(0x0F), zero = _mm256_setzero_si256();
+    __m256i ctrl = _mm256_set1_epi8(0x1F);
+    int i;
+    b->whitespace = b->op = b->quote = b->backslash = b->control = 0;
+    for (i = 0; i < 64; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(p + i));
+        __m256i t = _mm256_and_si256(
+            _mm256_shuffle_epi8(low, _mm256_and_si256(x, nibble)),
+            _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+        __m256i ws = _mm256_cmpeq_epi8(_mm256_and_si256(t, _mm256_set1_epi8(1 | 2)), zero);
+        __m256i op = _mm256_cmpeq_epi8(_mm256_and_si256(t, _mm256_set1_epi8(4 | 8 | 16)), zero);
+        b->whitespace |= (uint64_t)(unsigned int)~_mm256_movemask_epi8(ws) << i;
+        b->op |= (uint64_t)(unsigned int)~_mm256_movemask_epi8(op) << i;
+        b->quote |= (uint64_t)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\"'))) << i;
+        b->backslash |= (uint64_t)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\\'))) << i;
+        b->control |= (uint64_t)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(x, ctrl), ctrl)) << i;
+    }
+}
+
+static void (*mini_classify)(const char*, mini_block*) = mini_classify_scalar;
+
+__attribute__((constructor))
+static void mini_index_init(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        mini_classify = mini_classify_avx2;
+    else if (__builtin_cpu_supports("sse2"))
+        mini_classify = mini_classify_sse2;
+}
+
+#else
+
+#define mini_classify mini_classify_scalar
+
+#endif
+
+/* bit i set when an odd number of bits at or below i are set */
+static uint64_t mini_prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+/*
+ * the characters escaped by a backslash: each run of backslashes escapes
+ * every second one and the byte after an odd run. The subtraction carries
+ * a run from its start to its end in one step. *carry: the first byte of
+ * the next block is escaped.
+ */
+static uint64_t mini_escaped(uint64_t backslash, uint64_t* carry) {
+    uint64_t potential = backslash & ~*carry;
+    uint64_t code = (((potential << 1) | MINI_ODD_BITS) - potential) ^ MINI_ODD_BITS;
+    uint64_t escaped = code ^ (backslash | *carry);
+    *carry = (code & backslash) >> 63;
+    return escaped;
+}
+
+uint32_t* mini_build_index(const char* json, size_t len, size_t* count) {
+    uint64_t escape_carry = 0, in_string_carry = 0, scalar_carry = 0;
+    size_t i, n = 0, capacity = len / 8 + 64;
+    uint32_t* index;
+    char tail[64];
+    if (len >= UINT32_MAX)
+        return NULL;
+    index = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+    for (i = 0; i < len; i += 64) {
+        const char* p = json + i;
+        uint64_t escaped, quote, in_string, scalar, nonquote, structural;
+        mini_block b;
+        /* the last block is padded with spaces, nothing is read past len */
+        if (len - i < 64) {
+            memset(tail, ' ', 64);
+            memcpy(tail, p, len - i);
+            p = tail;
+        }
+        mini_classify(p, &b);
+        escaped = mini_escaped(b.backslash, &escape_carry);
+        quote = b.quote & ~escaped;
+        /* from an opening quote up to the byte before its closing quote */
+        in_string = mini_prefix_xor(quote) ^ in_string_carry;
+        in_string_carry = (uint64_t)((int64_t)in_string >> 63);
+        /* a token starts where a byte that is not an operator or whitespace follows one */
+        scalar = ~(b.op | b.whitespace);
+        nonquote = scalar & ~quote;
+        structural = (b.op | (scalar & ~((nonquote << 1) | scalar_carry))) & ~(in_string ^ quote);
+        scalar_carry = nonquote >> 63;
+        /* inside strings: where the string parser stops, up to the closing quote */
+        structural |= ((b.backslash & ~escaped) | b.control) & in_string & ~quote;
+        structural |= quote & ~in_string;
+        /* room for a full block and the final len */
+        if (n + 64 >= capacity) {
+            while (n + 64 >= capacity)
+                capacity *= 2;
+            index = (uint32_t*)realloc(index, capacity * sizeof(uint32_t));
+        }
+        while (structural != 0) {
+            index[n++] = (uint32_t)(i + __builtin_ctzll(structural));
+            structural &= structural - 1;
+        }
+    }
+    /* padding spaces are never structural, the offsets stay below len */
+    index[n] = (uint32_t)len;
+    *count = n;
+    return index;
+}
@@ -0,0 +1,16 @@
+#ifndef _MINI_INDEX_H__
+#define _MINI_INDEX_H__
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint32_t */
+
+/*
+ * stage 1 of the indexed parser: offsets of the structural characters and
+ * of the first byte of every token outside strings, and inside strings of
+ * each unescaped backslash, control character and the closing quote. In
+ * text order and followed by len; *count leaves the final len out. NULL
+ * when len does not fit 32-bit offsets; free() the result.
+ */
+uint32_t* mini_build_index(const char* json, size_t len, size_t* count);
+
+#endif
@@ -1,642 +1,2004 @@
-#include "mini_json.h"
-#include <assert.h>  /* assert() */
-#include <errno.h>   /* errno, ERANGE */
-#include <math.h>    /* HUGE_VAL */
-#include <stdlib.h>  /* NULL, malloc(), realloc(), free(), strtod() */
-#include <string.h>  /* memcpy() */
-
-#ifndef MINI_PARSE_STACK_INIT_SIZE
-#define MINI_PARSE_STACK_INIT_SIZE 256
-#endif
-
-#ifndef MINI_PARSE_BUILDER_INIT_SIZE
-#define MINI_PARSE_BUILDER_INIT_SIZE 256
-#endif
-
-#define EXPECT(c, ch)       do { assert(*c->json == (ch)); c->json++; } while(0)
-#define ISDIGIT(ch)         ((ch) >= '0' && (ch) <= '9')
-#define ISDIGIT1TO9(ch)     ((ch) >= '1' && (ch) <= '9')
-#define PUTC(c, ch)         do { *(char*)mini_context_push(c, sizeof(char)) = (ch); } while(0)
-#define PUTS(c, s, len)     memcpy(mini_context_push(c,len), s, len)
-
-void mini_show_value(const mini_value* v) {
-    assert(v != NULL);
-    size_t i;
-    switch(v->type){
-        case MINI_NULL : printf("null"); break;
-        case MINI_TRUE : printf("true"); break;
-        case MINI_FALSE : printf("false"); break;
-        case MINI_NUMBER : printf("%f", mini_get_number(v)); break;
-        case MINI_STRING : printf("\"%s\"", mini_get_string(v)); break;
-        case MINI_ARRAY : 
-                printf("[ ");
-                size_t size = mini_get_array_size(v);
-                for(i = 0; i < size; ++i) {
-                    if(i > 0) printf(" , ");
-                    mini_show_value(mini_get_array_element(v, i));
-                }
-                printf(" ]");
-                break;
-        case MINI_OBJECT : 
-                printf("{ ");
-                if(get_map(v) != NULL)
-                    map_show(get_map(v), show_item);
-                printf(" }");
-                break;
-    }
-}
-
-void mini_add_value_to_array(mini_value* arr, mini_value* v) {
-    assert(arr != NULL && v != NULL && arr->type == MINI_ARRAY);
-    mini_value* tmp = mini_backup(v);
-    size_t size = mini_get_array_size(arr);
-    if(size == 0){
-        arr->u.a.e = tmp;
-    }
-    else{
-        arr->u.a.e = (mini_value*)realloc(arr->u.a.e, sizeof(mini_value) * (size+1));
-        memcpy(arr->u.a.e+size, tmp, sizeof(mini_value));
-        free((void*)tmp);
-    }
-    arr->u.a.size += 1;
-}
-
-void mini_add_value_to_object(mini_value* obj, mini_value* key, mini_value* val) {
-    assert(obj != NULL && obj->type == MINI_OBJECT && key != NULL && val != NULL);
-    if(obj->u.o.pmap == NULL){
-        mini_init_object(obj);
-    }
-    mini_value *mkey = mini_backup(key);
-    mini_value *mval = mini_backup(val);
-    Item* pitem = new_item(mini_get_string(mkey), mval);
-    add_item(obj->u.o.pmap, pitem);
-    free(mkey);
-    free(mval);
-    obj->u.o.size += 1;
-}
-
-// for deep copy
-mini_value* mini_backup(mini_value* v){
-    char *tmp_json = NULL;
-    mini_value* ret = NULL;
-    size_t len;
-    if(MINI_GENERATE_OK == mini_generate(v, &tmp_json, &len)){
-        ret = (mini_value*)malloc(sizeof(mini_value));
-        if(MINI_PARSE_OK != mini_parse(ret, tmp_json)) {
-            free(ret);
-            ret = NULL;
-        }
-    }
-    if(tmp_json != NULL) free(tmp_json);
-    return ret;
-}
-
-static void* mini_context_push(mini_context* c, size_t size) {
-    void* ret;
-    assert(size > 0);
-    if (c->top + size >= c->size) {
-        if (c->size == 0)
-            c->size = MINI_PARSE_STACK_INIT_SIZE;
-        while (c->top + size >= c->size)
-            c->size += c->size >> 1;  /* c->size * 1.5 */
-        c->stack = (char*)realloc(c->stack, c->size);
-    }
-    ret = c->stack + c->top;
-    c->top += size;
-    return ret;
-}
-
-static void* mini_context_pop(mini_context* c, size_t size) {
-    assert(c->top >= size);
-    return c->stack + (c->top -= size);
-}
-
-static void mini_parse_whitespace(mini_context* c) {
-    const char *p = c->json;
-    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
-        p++;
-    c->json = p;
-}
-
-static int mini_parse_literal(mini_context* c, mini_value* v, const char* literal, mini_type type) {
-    size_t i;
-    EXPECT(c, literal[0]);
-    for (i = 0; literal[i + 1]; i++)
-        if (c->json[i] != literal[i + 1])
-            return MINI_PARSE_INVALID_VALUE;
-    c->json += i;
-    v->type = type;
-    return MINI_PARSE_OK;
-}
-
-static int mini_parse_number(mini_context* c, mini_value* v) {
-    const char* p = c->json;
-    if (*p == '-') p++;
-    if (*p == '0') p++;
-    else {
-        if (!ISDIGIT1TO9(*p)) return MINI_PARSE_INVALID_VALUE;
-        for (p++; ISDIGIT(*p); p++);
-    }
-    if (*p == '.') {
-        p++;
-        if (!ISDIGIT(*p)) return MINI_PARSE_INVALID_VALUE;
-        for (p++; ISDIGIT(*p); p++);
-    }
-    if (*p == 'e' || *p == 'E') {
-        p++;
-        if (*p == '+' || *p == '-') p++;
-        if (!ISDIGIT(*p)) return MINI_PARSE_INVALID_VALUE;
-        for (p++; ISDIGIT(*p); p++);
-    }
-    errno = 0;
-    v->u.n = strtod(c->json, NULL);
-    if (errno == ERANGE && (v->u.n == HUGE_VAL || v->u.n == -HUGE_VAL))
-        return MINI_PARSE_NUMBER_TOO_BIG;
-    v->type = MINI_NUMBER;
-    c->json = p;
-    return MINI_PARSE_OK;
-}
-
-static const char* mini_parse_hex4(const char* p, unsigned int* u) {
-    int i;
-    *u = 0;
-    for(i = 0; i<4; ++i){
-        char ch = *p++;
-        *u <<= 4;
-        if      (ch >= '0' && ch <= '9') *u |= ch - '0';
-        else if (ch >= 'a' && ch <= 'f') *u |= ch - ('a' - 10);
-        else if (ch >= 'A' && ch <= 'F') *u |= ch - ('A' - 10);
-        else    return NULL;
-    }
-    return p;
-}
-
-static void mini_encode_utf8(mini_context* c, unsigned int u){
-    if(u <= 0x7F)
-        PUTC(c, u & 0xFF);
-    else if(u <= 0x7FF) {
-        PUTC(c, 0xC0 | ((u >> 6) & 0xFF));
-        PUTC(c, 0x80 | ( u       & 0x3F));
-    }
-    else if(u <= 0xFFFF) {
-        PUTC(c, 0xE0 | ((u >> 12) & 0xFF));
-        PUTC(c, 0x80 | ((u >> 6)  & 0x3F));
-        PUTC(c, 0x80 | ( u        & 0x3F));
-    }
-    else {
-        assert(u <= 0x10FFFF);
-         PUTC(c, 0xF0 | ((u >> 18) & 0xFF));
-         PUTC(c, 0x80 | ((u >> 12) & 0x3F));
-         PUTC(c, 0x80 | ((u >>  6) & 0x3F));
-         PUTC(c, 0x80 | ( u        & 0x3F));
-    }
-}
-
-
-#define STRING_ERROR(ret) do { c->top = head; return ret; } while(0)
-static int mini_parse_string_raw(mini_context* c, char** str, size_t* len) {
-    size_t head = c->top;
-    unsigned int u, u2;
-    const char* p;
-    EXPECT(c, '\"');
-    p = c->json;
-    for (;;) {
-        char ch = *p++;
-        switch (ch) {
-            case '\"':
-                *len = c->top - head;
-                *str = mini_context_pop(c, *len);
-                c->json = p;
-                return MINI_PARSE_OK;
-            case '\\':
-                switch (*p++) {
-                    case '\"': PUTC(c, '\"'); break;
-                    case '\\': PUTC(c, '\\'); break;
-                    case '/':  PUTC(c, '/' ); break;
-                    case 'b':  PUTC(c, '\b'); break;
-                    case 'f':  PUTC(c, '\f'); break;
-                    case 'n':  PUTC(c, '\n'); break;
-                    case 'r':  PUTC(c, '\r'); break;
-                    case 't':  PUTC(c, '\t'); break;
-                    case 'u':
-                        if(!(p = mini_parse_hex4(p, &u)))
-                           STRING_ERROR(MINI_PARSE_INVALID_UNICODE_HEX);
-                        if(u >= 0xD800 && u <= 0xDBFF) {
-                            if(*p++ != '\\')
-                                STRING_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE);
-                            if(*p++ != 'u')
-                                STRING_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE);
-                            if(!(p = mini_parse_hex4(p, &u2)))
-                                STRING_ERROR(MINI_PARSE_INVALID_UNICODE_HEX);
-                            if(u2 < 0xDC00 || u2 > 0xDFFF)
-                                STRING_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE);
-                            u = (((u - 0xD800) << 10) | (u2 - 0xDC00)) + 0x10000;
-                        }
-                        mini_encode_utf8(c, u);
-                        break;
-                    default:
-                        STRING_ERROR(MINI_PARSE_INVALID_STRING_ESCAPE);
-                }
-                break;
-            case '\0':
-                STRING_ERROR(MINI_PARSE_MISS_QUOTATION_MARK);
-            default:
-                if ((unsigned char)ch < 0x20) { 
-                    STRING_ERROR(MINI_PARSE_INVALID_STRING_CHAR);
-                }
-                PUTC(c, ch);
-        }
-    }
-}
-
-static int mini_parse_string(mini_context* c, mini_value* v){
-    int ret;
-    char* s;
-    size_t len;
-    if((ret = mini_parse_string_raw(c, &s, &len)) == MINI_PARSE_OK)
-        mini_set_string(v, s, len);
-    return ret;
-}
-
-static int mini_parse_value(mini_context* c, mini_value* v);/* forward declare */
-
-static int mini_parse_array(mini_context* c, mini_value* v) {
-    size_t size = 0;
-    size_t i;
-    int ret;
-    EXPECT(c, '[');
-    mini_parse_whitespace(c);
-    if(*c->json == ']') {
-        c->json++;
-        v->type = MINI_ARRAY;
-        v->u.a.size = 0;
-        v->u.a.e = NULL;
-        return MINI_PARSE_OK;
-    }
-    for(;;) {
-        mini_value e;
-        mini_init(&e);
-        if((ret = mini_parse_value(c, &e)) != MINI_PARSE_OK) break;
-        memcpy(mini_context_push(c, sizeof(mini_value)), &e, sizeof(mini_value));
-        size++;
-        mini_parse_whitespace(c);
-        if(*c->json == ',') {
-            c->json++;
-            mini_parse_whitespace(c);
-        }
-        else if(*c->json == ']') {
-            c->json++;
-            v->type = MINI_ARRAY;
-            v->u.a.size = size;
-            size = size * sizeof(mini_value);
-            memcpy(v->u.a.e = (mini_value*)malloc(size), mini_context_pop(c, size), size);
-            return MINI_PARSE_OK;
-        }
-        else {
-            ret = MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
-            break;
-        }
-    }
-    for(i = 0; i < size; i++) {
-        mini_free((mini_value*)mini_context_pop(c, sizeof(mini_value)));
-    }
-    return ret;
-}
-
-static int mini_parse_object(mini_context* c, mini_value* v) {
-    size_t i,size;
-    mini_value key;
-    mini_value value;
-    int ret;
-
-    EXPECT(c, '{');
-    mini_parse_whitespace(c);
-    if(*c->json == '}') {
-        c->json++;
-        v->type = MINI_OBJECT;
-        v->u.o.pmap = NULL;
-        v->u.o.size = 0;
-        return MINI_PARSE_OK;
-    }
-    v->u.o.pmap = (Map *)malloc(sizeof(Map));
-    *(v->u.o.pmap) = map();
-    v->type = MINI_OBJECT;
-    size = 0;
-    for(;;){
-        mini_init(&key);
-        mini_init(&value);
-        /* parse key */
-        if(*c->json != '\"'){
-            ret = MINI_PARSE_MISS_KEY;
-            break;
-        }
-        if((ret = mini_parse_string(c, &key)) != MINI_PARSE_OK) 
-            break;
-        /* parse ws colon ws */
-        mini_parse_whitespace(c);
-        if(*c->json != ':'){
-            ret = MINI_PARSE_MISS_COLON;
-            break;
-        }
-        c->json++;
-        mini_parse_whitespace(c);
-        /* parse value */
-        if((ret = mini_parse_value(c, &value)) != MINI_PARSE_OK)
-            break;
-        Item *pitem = new_item(key.u.s.s, &value);
-        add_item(v->u.o.pmap, pitem);
-        size++;
-        mini_free(&key); //free the memory
-        /* parse ws [comma / right-curly-brae] ws */
-        mini_parse_whitespace(c);
-        if(*c->json == ','){
-            c->json++;
-            mini_parse_whitespace(c);
-        }
-        else if(*c->json == '}') {
-            c->json++;
-            v->u.o.size = size;
-            return MINI_PARSE_OK;
-        }
-        else{
-            ret = MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
-            break;
-        }
-    }
-    mini_free(&key);
-    mini_free(&value);
-    mini_free(v);
-    v->type = MINI_NULL;
-    return ret;
-}
-
-static int mini_parse_value(mini_context* c, mini_value* v) {
-    switch (*c->json) {
-        case 't':  return mini_parse_literal(c, v, "true", MINI_TRUE);
-        case 'f':  return mini_parse_literal(c, v, "false", MINI_FALSE);
-        case 'n':  return mini_parse_literal(c, v, "null", MINI_NULL);
-        case '"':  return mini_parse_string(c, v);
-        case '[':  return mini_parse_array(c, v);
-        case '{':  return mini_parse_object(c, v);
-        case '\0': return MINI_PARSE_EXPECT_VALUE;
-        default:   return mini_parse_number(c, v);
-    }
-}
-
-int mini_parse(mini_value* v, const char* json) {
-    mini_context c;
-    int ret;
-    assert(v != NULL);
-    c.json = json;
-    c.stack = NULL;
-    c.size = c.top = 0;
-    mini_init(v);
-    mini_parse_whitespace(&c);
-    if ((ret = mini_parse_value(&c, v)) == MINI_PARSE_OK) {
-        mini_parse_whitespace(&c);
-        if (*c.json != '\0') {
-            v->type = MINI_NULL;
-            ret = MINI_PARSE_ROOT_NOT_SINGULAR;
-        }
-    }
-    assert(c.top == 0);
-    free(c.stack);
-    return ret;
-}
-
-void mini_free(mini_value* v) {
-    size_t i;
-    assert(v != NULL);
-    switch(v->type) {
-        case MINI_STRING:
-            free(v->u.s.s);
-            break;
-        case MINI_ARRAY:
-            for(i = 0; i < v->u.a.size; i++)
-                mini_free(&v->u.a.e[i]);
-            free(v->u.a.e);
-            break;
-        case MINI_OBJECT:
-            if(v->u.o.pmap == NULL) break;
-            map_clear(v->u.o.pmap, inner_clear);
-            free(v->u.o.pmap);
-            break;
-        default:
-            break;
-    }
-    v->type = MINI_NULL;
-}
-
-mini_type mini_get_type(const mini_value* v) {
-    assert(v != NULL);
-    return v->type;
-}
-
-void mini_set_type(mini_value* v, mini_type type) {
-    assert(v != NULL);
-    v->type = type;
-}
-
-int mini_get_boolean(const mini_value* v) {
-    assert(v != NULL && (v->type == MINI_TRUE || v->type == MINI_FALSE));
-    return v->type == MINI_TRUE;
-}
-
-void mini_set_boolean(mini_value* v, int b) {
-    mini_free(v);
-    v->type = b ? MINI_TRUE : MINI_FALSE;
-}
-
-double mini_get_number(const mini_value* v) {
-    assert(v != NULL && v->type == MINI_NUMBER);
-    return v->u.n;
-}
-
-void mini_set_number(mini_value* v, double n) {
-    mini_free(v);
-    v->u.n = n;
-    v->type = MINI_NUMBER;
-}
-
-const char* mini_get_string(const mini_value* v) {
-    assert(v != NULL && v->type == MINI_STRING);
-    return v->u.s.s;
-}
-
-size_t mini_get_string_length(const mini_value* v) {
-    assert(v != NULL && v->type == MINI_STRING);
-    return v->u.s.len;
-}
-
-void mini_set_string(mini_value* v, const char* s, size_t len) {
-    assert(v != NULL && (s != NULL || len == 0));
-    mini_free(v);
-    v->u.s.s = (char*)malloc(len + 1);
-    memcpy(v->u.s.s, s, len);
-    v->u.s.s[len] = '\0';
-    v->u.s.len = len;
-    v->type = MINI_STRING;
-}
-
-void mini_init_array(mini_value* v) {
-    assert(v != NULL);
-    v->type = MINI_ARRAY;
-    v->u.a.size = 0;
-}
-
-size_t mini_get_array_size(const mini_value* v) {
-    assert(v != NULL && v->type == MINI_ARRAY);
-    return v->u.a.size;
-}
-
-mini_value* mini_get_array_element(const mini_value* v, size_t index) {
-    assert(v != NULL && v->type == MINI_ARRAY);
-    assert(index < v->u.a.size);
-    return &v->u.a.e[index];
-}
-
-void mini_init_object(mini_value* v) {
-    assert(v != NULL);
-    v->type = MINI_OBJECT;
-    v->u.o.pmap = (Map*)malloc(sizeof(Map));
-    *(v->u.o.pmap) = map();
-}
-
-size_t mini_get_object_size(const mini_value* v) {
-    assert(v != NULL && v->type == MINI_OBJECT);
-    return v->u.o.size;
-}
-
-mini_value* mini_get_object_value(const mini_value* v, const char* key) {
-    assert(v != NULL && v->type == MINI_OBJECT);
-    return (mini_value*)value(v->u.o.pmap, key);
-}
-
-static void mini_generate_string(mini_context* c, const char* s, size_t len) {
-    static const char hex_digits[] = {'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'};
-    size_t i, size;
-    char* head, *p;
-    assert(s != NULL);
-    p = head = mini_context_push(c, size = len * 6 + 2); /* "\u00xx ... " */
-    *p++ = '"';
-    for(i = 0; i < len; i++){
-        unsigned char ch = (unsigned char)s[i];
-        switch(ch) {
-            case '\"' : *p++ = '\\', *p++ = '\"';break;
-            case '\\' : *p++ = '\\'; *p++ = '\\'; break;
-            case '\b' : *p++ = '\\'; *p++ = 'b';  break;
-            case '\f' : *p++ = '\\'; *p++ = 'f';  break;
-            case '\n' : *p++ = '\\'; *p++ = 'n';  break;
-            case '\r' : *p++ = '\\'; *p++ = 'r';  break;
-            case '\t' : *p++ = '\\'; *p++ = 't';  break;
-            default :
-                if( ch < 0x20) {
-                    *p++ = '\\'; *p++ = 'u'; *p++ = '0'; *p++ = '0';
-                    *p++ = hex_digits[ch >> 4];
-                    *p++ = hex_digits[ch & 15];
-                }
-                else
-                    *p++ = s[i];
-        }
-    }
-    *p++ = '"';
-    c->top -= size - (p - head);
-}
-
-static void mini_generate_value(mini_context* c, const mini_value* v) {
-    size_t i;
-    size_t len;
-    switch(v->type) {
-        case MINI_NULL : PUTS(c, "null", 4);break;
-        case MINI_TRUE : PUTS(c, "true", 4);break;
-        case MINI_FALSE : PUTS(c, "false", 5);break;
-        case MINI_NUMBER ://使用sprintf("%.17g",...)来把浮点数转换成文本
-                len = sprintf(mini_context_push(c, 32), "%.17g", v->u.n);
-                c->top -= 32 - len;
-                break;
-        case MINI_STRING : mini_generate_string(c, v->u.s.s, v->u.s.len); break;
-        case MINI_ARRAY :
-                len = mini_get_array_size(v);
-                PUTC(c, '[');
-                for(i = 0; i < len; ++i){
-                    if(i > 0) PUTC(c, ',');
-                    mini_generate_value(c, &v->u.a.e[i]);
-                }
-                PUTC(c, ']');
-                break;
-        case MINI_OBJECT :
-                PUTC(c, '{');
-                if(get_map(v) != NULL) //don`t hava {key:value}
-                    //mini_traverse_map_for_object(c, v);
-                    mini_traverse(c, v);
-                PUTC(c, '}');
-                break;
-    }
-}
-
-int mini_generate(const mini_value* v, char** json, size_t* length) {
-    mini_context c;
-    size_t ret;
-    assert(v != NULL);
-    assert(json != NULL);
-    c.stack = (char*)malloc(c.size = MINI_PARSE_BUILDER_INIT_SIZE);
-    c.top = 0;
-    mini_generate_value(&c, v);
-    if(length)
-        *length = c.top;
-    PUTC(&c, '\0');
-    *json = c.stack;
-    return MINI_GENERATE_OK;
-}
-
-Map* get_map(const mini_value* v) {
-    assert(v != NULL && v->type == MINI_OBJECT);
-    return v->u.o.pmap;
-}
-Item* new_item(const char* key, void *value) {
-    Item *p = (Item*)lalloc(sizeof(Item), 1);
-    p->key = (char*)lalloc(sizeof(char), strlen(key)+1);
-    strcpy(p->key, key);
-    p->value = lalloc(sizeof(mini_value), 1);
-    memcpy(p->value, (mini_value*)value, sizeof(mini_value));
-    return p;
-}
-
-void inner_clear(void* p) {
-    Item* pitem = (Item *)p;
-    mini_free(pitem->value);
-    lfree(pitem->key);
-    lfree(pitem->value);
-    lfree(pitem);
-}
-
-void show_item(void *data) {
-    Item* pitem = (Item *)data;
-    mini_value *value = (mini_value*)pitem->value;
-    printf("%s : ",pitem->key);
-    mini_show_value(value);
-    printf("\n");
-}
-
-void traverse_map_to_do(mini_context* c, void *data, size_t* i) {
-    if(*i > 0) PUTC(c, ',');
-    Item *pitem = (Item*)data;
-    mini_value* val = (mini_value*)pitem->value;
-    mini_generate_string(c, pitem->key, strlen(pitem->key));
-    PUTC(c, ':');
-    mini_generate_value(c, val);
-    *i += 1;
-}
-
-void _traverse(Node* p, Node* tail, mini_context* c, size_t* i, void(*func)(mini_context* , void *, size_t*)) {
-    if(p->left != tail) _traverse(p->left, tail, c, i, func);
-    func(c, p->data, i);
-    if(p->right != tail) _traverse(p->right, tail, c, i, func);
-}
-
-void mini_traverse(mini_context* c, const mini_value* v){
-    Map* pmap = get_map(v);
-    size_t i = 0;
-    _traverse(pmap->tree->root, pmap->tree->tail, c, &i, traverse_map_to_do);
-}
-
+#include "mini_json.h"
+#include "mini_index.h"
+#include "mini_number.h"
+#include "mini_scan.h"
+#include <assert.h>  /* assert() */
+#include <math.h>    /* HUGE_VAL */
+#include <stdlib.h>  /* NULL, malloc(), realloc(), free() */
+#include <string.h>  /* memcpy() */
+
+#ifndef MINI_PARSE_STACK_INIT_SIZE
+#define MINI_PARSE_STACK_INIT_SIZE 256
+#endif
+
+#ifndef MINI_PARSE_BUILDER_INIT_SIZE
+#define MINI_PARSE_BUILDER_INIT_SIZE 256
+#endif
+
+#ifndef MINI_GENERATE_CHUNK_SIZE
+#define MINI_GENERATE_CHUNK_SIZE 4096
+#endif
+
+#ifndef MINI_WALK_LOCAL_SIZE
+#define MINI_WALK_LOCAL_SIZE 32
+#endif
+
+#define EXPECT(c, ch)       do { assert(*c->json == (ch)); c->json++; } while(0)
+#define PUTC(c, ch)         do { *(char*)mini_context_push(c, sizeof(char)) = (ch); } while(0)
+#define PUTS(c, s, len)     memcpy(mini_context_push(c,len), s, len)
+#define MEMBER_KEY(m)       ((m)->klen < MINI_KEY_INLINE_SIZE ? (m)->k.s : (m)->k.p)
+#define SAX_EVENT(call)     ((call) == 0 ? MINI_PARSE_OK : MINI_PARSE_STOPPED)
+#define ATEND(c, p)         ((p) == (c)->end || ((c)->end == NULL && *(p) == '\0'))
+#define PEEK(c)             ((c)->json != (c)->end ? *(c)->json : '\0')
+#define ISWHITESPACE(ch)    ((ch) == ' ' || (ch) == '\t' || (ch) == '\n' || (ch) == '\r')
+#define ISNUMBERCHAR(ch)    (((ch) >= '0' && (ch) <= '9') || (ch) == '-' || (ch) == '+' || (ch) == '.' || (ch) == 'e' || (ch) == 'E')
+#define LOAD(v)             do { if ((v)->type == MINI_LAZY) mini_lazy_load((mini_value*)(v)); } while(0)
+
+/* a node of a lazy document that is not built yet, never seen through the interface */
+#define MINI_LAZY ((mini_type)(MINI_OBJECT + 1))
+
+/* object index entry, pos is the member index + 1 and 0 marks an empty slot */
+typedef struct {
+    unsigned int hash, pos;
+}mini_slot;
+
+static void mini_lazy_load(mini_value* v); /* forward declare */
+
+void mini_show_value(const mini_value* v) {
+    assert(v != NULL);
+    size_t i;
+    LOAD(v);
+    switch(v->type){
+        case MINI_NULL : printf("null"); break;
+        case MINI_TRUE : printf("true"); break;
+        case MINI_FALSE : printf("false"); break;
+        case MINI_NUMBER : printf("%f", mini_get_number(v)); break;
+        case MINI_STRING : printf("\"%s\"", mini_get_string(v)); break;
+        case MINI_ARRAY : 
+                printf("[ ");
+                size_t size = mini_get_array_size(v);
+                for(i = 0; i < size; ++i) {
+                    if(i > 0) printf(" , ");
+                    mini_show_value(mini_get_array_element(v, i));
+                }
+                printf(" ]");
+                break;
+        case MINI_OBJECT : 
+                printf("{ ");
+                for(i = 0; i < v->u.o.size; ++i) {
+                    printf("%s : ", MEMBER_KEY(&v->u.o.m[i]));
+                    mini_show_value(&v->u.o.m[i].v);
+                    printf("\n");
+                }
+                printf(" }");
+                break;
+    }
+}
+
+static void mini_grow_array(mini_value* arr) {
+    if(arr->u.a.size == arr->u.a.capacity)
+        mini_reserve_array(arr, arr->u.a.capacity == 0 ? 4 : arr->u.a.capacity * 2);
+}
+
+/* v may live inside arr, it is copied out before the elements move */
+void mini_add_value_to_array(mini_value* arr, mini_value* v) {
+    assert(arr != NULL && v != NULL && arr->type == MINI_ARRAY);
+    size_t size = mini_get_array_size(arr);
+    mini_value e;
+    mini_init(&e);
+    mini_copy(&e, v);
+    mini_grow_array(arr);
+    memcpy(&arr->u.a.e[size], &e, sizeof(mini_value));
+    arr->u.a.size += 1;
+}
+
+/******************************************
+ *
+ *              object
+ *
+ ******************************************/
+static unsigned int mini_hash_key(const char* key, size_t len) {
+    unsigned int h = 2166136261u; /* FNV-1a */
+    size_t i;
+    for(i = 0; i < len; i++)
+        h = (h ^ (unsigned char)key[i]) * 16777619u;
+    return h;
+}
+
+/*
+ * the index is a power of two at most half full, it lives right behind the
+ * members. Small objects have none: scanning a few keys is cheaper than hashing.
+ */
+static size_t mini_index_capacity(size_t capacity) {
+    size_t n = 8;
+    if(capacity <= MINI_OBJECT_SCAN_SIZE) return 0;
+    while(n < capacity * 2) n <<= 1;
+    return n;
+}
+
+static size_t mini_object_bytes(size_t capacity) {
+    return capacity * sizeof(mini_member) + mini_index_capacity(capacity) * sizeof(mini_slot);
+}
+
+static mini_slot* mini_object_index(const mini_value* v) {
+    return (mini_slot*)(v->u.o.m + v->u.o.capacity);
+}
+
+/* length first, the first byte next, then the whole key */
+static size_t mini_object_scan(const mini_value* v, const char* key, size_t len) {
+    size_t i;
+    for(i = 0; i < v->u.o.size; i++) {
+        const mini_member* m = &v->u.o.m[i];
+        if(m->klen == len && (len == 0 || (MEMBER_KEY(m)[0] == key[0] && memcmp(MEMBER_KEY(m), key, len) == 0)))
+            return i;
+    }
+    return MINI_KEY_NOT_EXIST;
+}
+
+static size_t mini_object_find(const mini_value* v, const char* key, size_t len) {
+    const mini_slot* slots;
+    size_t i, mask;
+    unsigned int hash;
+    if(v->u.o.size == 0)
+        return MINI_KEY_NOT_EXIST;
+    if(v->u.o.capacity <= MINI_OBJECT_SCAN_SIZE)
+        return mini_object_scan(v, key, len);
+    hash = mini_hash_key(key, len);
+    slots = mini_object_index(v);
+    mask = mini_index_capacity(v->u.o.capacity) - 1;
+    for(i = hash & mask; slots[i].pos != 0; i = (i + 1) & mask) {
+        if(slots[i].hash == hash) {
+            const mini_member* m = &v->u.o.m[slots[i].pos - 1];
+            if(m->klen == len && memcmp(MEMBER_KEY(m), key, len) == 0)
+                return slots[i].pos - 1;
+        }
+    }
+    return MINI_KEY_NOT_EXIST;
+}
+
+/* index member pos, an equal key met on the way keeps its slot (first one wins) */
+static void mini_object_index_insert(mini_value* v, size_t pos) {
+    mini_slot* slots = mini_object_index(v);
+    size_t i, mask = mini_index_capacity(v->u.o.capacity) - 1;
+    const mini_member* n = &v->u.o.m[pos];
+    unsigned int hash;
+    if(v->u.o.capacity <= MINI_OBJECT_SCAN_SIZE)
+        return;
+    hash = mini_hash_key(MEMBER_KEY(n), n->klen);
+    for(i = hash & mask; slots[i].pos != 0; i = (i + 1) & mask) {
+        if(slots[i].hash == hash) {
+            const mini_member* m = &v->u.o.m[slots[i].pos - 1];
+            if(m->klen == n->klen && memcmp(MEMBER_KEY(m), MEMBER_KEY(n), n->klen) == 0)
+                return;
+        }
+    }
+    slots[i].hash = hash;
+    slots[i].pos = (unsigned int)(pos + 1);
+}
+
+/* builds the index once the object is too large to scan */
+static void mini_object_rehash(mini_value* v) {
+    size_t i;
+    if(v->u.o.capacity <= MINI_OBJECT_SCAN_SIZE)
+        return;
+    memset(mini_object_index(v), 0, mini_index_capacity(v->u.o.capacity) * sizeof(mini_slot));
+    for(i = 0; i < v->u.o.size; i++)
+        mini_object_index_insert(v, i);
+}
+
+/* copy the key into the member, short keys are stored inline */
+static void mini_member_set_key(mini_member* m, const char* key, size_t len, Arena* arena) {
+    char* k = m->k.s;
+    if(len >= MINI_KEY_INLINE_SIZE)
+        k = m->k.p = (char*)(arena != NULL ? arena_alloc(arena, len + 1) : lmalloc(len + 1));
+    memcpy(k, key, len);
+    k[len] = '\0';
+    m->klen = len;
+}
+
+/* steal the buffer of a string value, the value is left as MINI_NULL */
+static void mini_member_move_key(mini_member* m, mini_value* key) {
+    if(key->u.s.len >= MINI_KEY_INLINE_SIZE) {
+        m->k.p = key->u.s.s;
+        m->klen = key->u.s.len;
+        mini_init(key);
+    }
+    else {
+        mini_member_set_key(m, key->u.s.s, key->u.s.len, NULL);
+        mini_free(key);
+    }
+}
+
+static void mini_member_free(mini_member* m) {
+    if(m->klen >= MINI_KEY_INLINE_SIZE)
+        lfree(m->k.p);
+    mini_free(&m->v);
+}
+
+/* a new member slot at the end of obj, the caller fills it and indexes it */
+static mini_member* mini_object_new_member(mini_value* obj) {
+    if(obj->u.o.size == obj->u.o.capacity)
+        mini_reserve_object(obj, obj->u.o.capacity == 0 ? 4 : obj->u.o.capacity * 2);
+    return &obj->u.o.m[obj->u.o.size];
+}
+
+/* appends a member built aside, an equal key already in obj stays in front of it */
+static void mini_object_append(mini_value* obj, const mini_member* n) {
+    memcpy(mini_object_new_member(obj), n, sizeof(mini_member));
+    mini_object_index_insert(obj, obj->u.o.size);
+    obj->u.o.size += 1;
+}
+
+/* key and val may live inside obj, the member is built before obj is touched */
+void mini_add_value_to_object(mini_value* obj, mini_value* key, mini_value* val) {
+    assert(obj != NULL && obj->type == MINI_OBJECT && key != NULL && val != NULL);
+    assert(key->type == MINI_STRING);
+    mini_member n;
+    mini_init(&n.v);
+    mini_copy(&n.v, val);
+    mini_member_set_key(&n, key->u.s.s, key->u.s.len, NULL);
+    mini_object_append(obj, &n);
+}
+
+void mini_move_value_to_array(mini_value* arr, mini_value* v) {
+    assert(arr != NULL && v != NULL && arr->type == MINI_ARRAY && arr != v);
+    size_t size = mini_get_array_size(arr);
+    mini_value e;
+    memcpy(&e, v, sizeof(mini_value));
+    mini_init(v);
+    mini_grow_array(arr);
+    memcpy(&arr->u.a.e[size], &e, sizeof(mini_value));
+    arr->u.a.size += 1;
+}
+
+void mini_move_value_to_object(mini_value* obj, mini_value* key, mini_value* val) {
+    assert(obj != NULL && obj->type == MINI_OBJECT && key != NULL && val != NULL);
+    assert(key->type == MINI_STRING && obj != val);
+    mini_member n;
+    memcpy(&n.v, val, sizeof(mini_value)); /* taken first, val may live inside obj */
+    mini_init(val);
+    mini_member_move_key(&n, key); /* steals the key buffer */
+    mini_object_append(obj, &n);
+}
+
+void mini_move(mini_value* dst, mini_value* src) {
+    assert(dst != NULL && src != NULL && dst != src);
+    mini_free(dst);
+    memcpy(dst, src, sizeof(mini_value));
+    mini_init(src);
+}
+
+static void* mini_context_push(mini_context* c, size_t size) {
+    void* ret;
+    assert(size > 0);
+    if (c->top + size >= c->size) {
+        if (c->size == 0)
+            c->size = MINI_PARSE_STACK_INIT_SIZE;
+        while (c->top + size >= c->size)
+            c->size += c->size >> 1;  /* c->size * 1.5 */
+        c->stack = (char*)realloc(c->stack, c->size);
+    }
+    ret = c->stack + c->top;
+    c->top += size;
+    return ret;
+}
+
+static void* mini_context_pop(mini_context* c, size_t size) {
+    assert(c->top >= size);
+    return c->stack + (c->top -= size);
+}
+
+/* in document mode every string, array buffer and object node is carved from c->arena */
+static void* mini_context_alloc(mini_context* c, size_t size) {
+    return c->arena != NULL ? arena_alloc(c->arena, size) : lmalloc(size);
+}
+
+/* partial results of a failed parse, the arena releases them as a whole */
+static void mini_context_free_value(mini_context* c, mini_value* v) {
+    if(c->arena == NULL)
+        mini_free(v);
+    else
+        mini_init(v);
+}
+
+static void mini_context_free_member(mini_context* c, mini_member* m) {
+    if(c->arena == NULL)
+        mini_member_free(m);
+}
+
+/* the first indexed byte at or after p */
+static const char* mini_parse_next_index(mini_context* c, const char* p) {
+    while (c->text + c->index[c->next] < p)
+        c->next++;
+    return c->text + c->index[c->next];
+}
+
+static void mini_parse_whitespace(mini_context* c) {
+    if (c->index != NULL) {
+        /*
+         * after whitespace the next byte is always indexed. A token never
+         * ends in whitespace, so a byte that is not one stays for the caller.
+         */
+        const char* q = mini_parse_next_index(c, c->json);
+        if (c->json != c->end && ISWHITESPACE(*c->json))
+            c->json = q;
+        return;
+    }
+    c->json = mini_skip_whitespace(c->json, c->end);
+}
+
+/* reports a parsed null, boolean or number to the handler */
+static int mini_sax_scalar(mini_context* c, const mini_value* v) {
+    const mini_handler* h = c->handler;
+    void* user = c->handler_user;
+    switch(v->type) {
+        case MINI_NULL:   return h->null_value == NULL ? MINI_PARSE_OK : SAX_EVENT(h->null_value(user));
+        case MINI_FALSE:
+        case MINI_TRUE:   return h->boolean == NULL ? MINI_PARSE_OK : SAX_EVENT(h->boolean(user, v->type == MINI_TRUE));
+        case MINI_NUMBER: return h->number == NULL ? MINI_PARSE_OK : SAX_EVENT(h->number(user, &v->u.n));
+        default:          return MINI_PARSE_OK;
+    }
+}
+
+static int mini_sax_start(mini_context* c, int (*event)(void*)) {
+    return event == NULL ? MINI_PARSE_OK : SAX_EVENT(event(c->handler_user));
+}
+
+static int mini_sax_end(mini_context* c, int (*event)(void*, size_t), size_t size) {
+    return event == NULL ? MINI_PARSE_OK : SAX_EVENT(event(c->handler_user, size));
+}
+
+static int mini_parse_literal(mini_context* c, mini_value* v, const char* literal, mini_type type) {
+    size_t i;
+    EXPECT(c, literal[0]);
+    for (i = 0; literal[i + 1]; i++)
+        if (c->json + i == c->end || c->json[i] != literal[i + 1])
+            return MINI_PARSE_INVALID_VALUE;
+    c->json += i;
+    v->type = type;
+    return c->handler != NULL ? mini_sax_scalar(c, v) : MINI_PARSE_OK;
+}
+
+/*
+ * the reader stops at the first byte out of the number grammar. Only when
+ * the text ends in such bytes can a number run into the end, and then it
+ * is read from a terminated copy.
+ */
+static int mini_parse_number(mini_context* c, mini_value* v) {
+    const char* p = c->json;
+    if (c->end != NULL && ISNUMBERCHAR(c->end[-1])) {
+        while (p != c->end && ISNUMBERCHAR(*p))
+            p++;
+    }
+    if (p != c->end)
+        p = mini_read_number(c->json, &v->u.n);
+    else {
+        size_t len = c->end - c->json;
+        char* copy;
+        PUTS(c, c->json, len);
+        PUTC(c, '\0');
+        copy = (char*)mini_context_pop(c, len + 1);
+        if ((p = mini_read_number(copy, &v->u.n)) != NULL)
+            p = c->json + (p - copy);
+    }
+    if (p == NULL)
+        return MINI_PARSE_INVALID_VALUE;
+    if (v->u.n.kind == MINI_NUMBER_DOUBLE && (v->u.n.v.d == HUGE_VAL || v->u.n.v.d == -HUGE_VAL))
+        return MINI_PARSE_NUMBER_TOO_BIG;
+    v->type = MINI_NUMBER;
+    c->json = p;
+    return c->handler != NULL ? mini_sax_scalar(c, v) : MINI_PARSE_OK;
+}
+
+static const char* mini_parse_hex4(const char* p, const char* end, unsigned int* u) {
+    int i;
+    *u = 0;
+    if(end != NULL && end - p < 4)
+        return NULL;
+    for(i = 0; i<4; ++i){
+        char ch = *p++;
+        *u <<= 4;
+        if      (ch >= '0' && ch <= '9') *u |= ch - '0';
+        else if (ch >= 'a' && ch <= 'f') *u |= ch - ('a' - 10);
+        else if (ch >= 'A' && ch <= 'F') *u |= ch - ('A' - 10);
+        else    return NULL;
+    }
+    return p;
+}
+
+static void mini_encode_utf8(mini_context* c, unsigned int u){
+    if(u <= 0x7F)
+        PUTC(c, u & 0xFF);
+    else if(u <= 0x7FF) {
+        PUTC(c, 0xC0 | ((u >> 6) & 0xFF));
+        PUTC(c, 0x80 | ( u       & 0x3F));
+    }
+    else if(u <= 0xFFFF) {
+        PUTC(c, 0xE0 | ((u >> 12) & 0xFF));
+        PUTC(c, 0x80 | ((u >> 6)  & 0x3F));
+        PUTC(c, 0x80 | ( u        & 0x3F));
+    }
+    else {
+        assert(u <= 0x10FFFF);
+         PUTC(c, 0xF0 | ((u >> 18) & 0xFF));
+         PUTC(c, 0x80 | ((u >> 12) & 0x3F));
+         PUTC(c, 0x80 | ((u >>  6) & 0x3F));
+         PUTC(c, 0x80 | ( u        & 0x3F));
+    }
+}
+
+
+#define STRING_ERROR(ret) do { c->top = head; return ret; } while(0)
+/* *str points into the json text when the string has no escapes, into the stack otherwise */
+static int mini_parse_string_raw(mini_context* c, const char** str, size_t* len) {
+    size_t head = c->top;
+    unsigned int u, u2;
+    const char* p;
+    EXPECT(c, '\"');
+    p = c->json;
+    for (;;) {
+        /* plain characters are copied a run at a time, the index holds where the run ends */
+        const char* q = c->index != NULL ? mini_parse_next_index(c, p) : mini_scan_string(p, c->end);
+        if (ATEND(c, q))
+            STRING_ERROR(MINI_PARSE_MISS_QUOTATION_MARK);
+        if (*q == '\"' && c->top == head) {
+            *str = p;
+            *len = q - p;
+            c->json = q + 1;
+            return MINI_PARSE_OK;
+        }
+        if (q != p) {
+            PUTS(c, p, q - p);
+            p = q;
+        }
+        char ch = *p++;
+        switch (ch) {
+            case '\"':
+                *len = c->top - head;
+                *str = mini_context_pop(c, *len);
+                c->json = p;
+                return MINI_PARSE_OK;
+            case '\\':
+                switch (p != c->end ? *p++ : '\0') {
+                    case '\"': PUTC(c, '\"'); break;
+                    case '\\': PUTC(c, '\\'); break;
+                    case '/':  PUTC(c, '/' ); break;
+                    case 'b':  PUTC(c, '\b'); break;
+                    case 'f':  PUTC(c, '\f'); break;
+                    case 'n':  PUTC(c, '\n'); break;
+                    case 'r':  PUTC(c, '\r'); break;
+                    case 't':  PUTC(c, '\t'); break;
+                    case 'u':
+                        if(!(p = mini_parse_hex4(p, c->end, &u)))
+                           STRING_ERROR(MINI_PARSE_INVALID_UNICODE_HEX);
+                        if(u >= 0xD800 && u <= 0xDBFF) {
+                            if((c->end != NULL && c->end - p < 2) || *p++ != '\\')
+                                STRING_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE);
+                            if(*p++ != 'u')
+                                STRING_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE);
+                            if(!(p = mini_parse_hex4(p, c->end, &u2)))
+                                STRING_ERROR(MINI_PARSE_INVALID_UNICODE_HEX);
+                            if(u2 < 0xDC00 || u2 > 0xDFFF)
+                                STRING_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE);
+                            u = (((u - 0xD800) << 10) | (u2 - 0xDC00)) + 0x10000;
+                        }
+                        mini_encode_utf8(c, u);
+                        break;
+                    default:
+                        STRING_ERROR(MINI_PARSE_INVALID_STRING_ESCAPE);
+                }
+                break;
+            default:
+                if ((unsigned char)ch < 0x20) { 
+                    STRING_ERROR(MINI_PARSE_INVALID_STRING_CHAR);
+                }
+                PUTC(c, ch);
+        }
+    }
+}
+
+/* in-situ mode: the decoded string is moved over its own text and terminated there */
+static int mini_parse_string_insitu(mini_context* c, const char** str, size_t* len) {
+    char* dst = (char*)c->json + 1;
+    int ret;
+    if((ret = mini_parse_string_raw(c, str, len)) != MINI_PARSE_OK)
+        return ret;
+    if(*str != dst) /* escaped: decoded on the stack, never longer than the text */
+        memcpy(dst, *str, *len);
+    dst[*len] = '\0';
+    *str = dst;
+    return MINI_PARSE_OK;
+}
+
+static int mini_parse_string(mini_context* c, mini_value* v){
+    int ret;
+    const char* s;
+    size_t len;
+    ret = c->insitu ? mini_parse_string_insitu(c, &s, &len) : mini_parse_string_raw(c, &s, &len);
+    if(ret == MINI_PARSE_OK) {
+        if(c->handler != NULL) {
+            if(c->handler->string != NULL)
+                ret = SAX_EVENT(c->handler->string(c->handler_user, s, len));
+        }
+        else if(c->arena == NULL)
+            mini_set_string(v, s, len);
+        else if(c->insitu) {
+            v->u.s.s = (char*)s;
+            v->u.s.len = len;
+            v->type = MINI_STRING;
+        }
+        else {
+            v->u.s.s = (char*)arena_alloc(c->arena, len + 1);
+            memcpy(v->u.s.s, s, len);
+            v->u.s.s[len] = '\0';
+            v->u.s.len = len;
+            v->type = MINI_STRING;
+        }
+    }
+    return ret;
+}
+
+/* the text is valid: a string ends at the first '"' that is not escaped */
+static const char* mini_skip_string(const char* p, const char* end) {
+    for (;;) {
+        p = mini_scan_string(p, end);
+        if (*p == '\"')
+            return p + 1;
+        p += 2;
+    }
+}
+
+/* end of the valid string or number at p */
+static const char* mini_skip_value(const char* p, const char* end) {
+    if (*p == '\"')
+        return mini_skip_string(p + 1, end);
+    while (p != end && ISNUMBERCHAR(*p))
+        p++;
+    return p;
+}
+
+/* end of the container at p, from the marks of the validating parse */
+static const char* mini_mark_find(const mini_context* c, const char* p) {
+    size_t lo = 0, hi = c->nmarks / 2;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (c->marks[2 * mid] < p)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    assert(lo < c->nmarks / 2 && c->marks[2 * lo] == p);
+    return c->marks[2 * lo + 1];
+}
+
+/* lazy mode: below the level being built only literals are read, the rest keeps its text */
+#define ISLAZY(c, ch)       ((c)->lazy && (ch) != 't' && (ch) != 'f' && (ch) != 'n')
+
+static void mini_parse_lazy_value(mini_context* c, mini_value* v) {
+    v->type = MINI_LAZY;
+    v->u.l.json = c->json;
+    v->u.l.end = c->end;
+    v->u.l.doc = c->doc;
+    if (*c->json == '[' || *c->json == '{')
+        c->json = mini_mark_find(c, c->json);
+    else
+        c->json = mini_skip_value(c->json, c->end);
+}
+
+/* a lazy document is validated first: every container is recorded as its start and end */
+static size_t mini_mark_open(mini_context* c) {
+    if (c->nmarks + 2 > c->marks_size) {
+        c->marks_size *= 2;
+        c->marks = (const char**)realloc((void*)c->marks, c->marks_size * sizeof(const char*));
+    }
+    c->marks[c->nmarks] = c->json;
+    c->nmarks += 2;
+    return c->nmarks - 1;
+}
+
+#define MARK_OPEN(c)        ((c)->marks_size != 0 ? mini_mark_open(c) : 0)
+#define MARK_CLOSE(c, mark) do { if ((c)->marks_size != 0) (c)->marks[mark] = (c)->json; } while(0)
+
+/*
+ * an open array or object on c->stack, its elements or members are pushed
+ * above it. Frames are linked by offset, the stack moves when it grows.
+ */
+typedef struct {
+    size_t parent;  /* MINI_NO_FRAME at the root */
+    size_t size;    /* complete elements or members, saved while a child is open */
+    size_t mark;
+    char kind;      /* '[' or '{' */
+}mini_frame;
+
+#define MINI_NO_FRAME       ((size_t)-1)
+#define FRAME(c, off)       ((mini_frame*)((c)->stack + (off)))
+#define CLOSER(kind)        ((kind) == '[' ? ']' : '}')
+
+static int mini_parse_scalar(mini_context* c, mini_value* v) {
+    switch (*c->json) {
+        case 't':  return mini_parse_literal(c, v, "true", MINI_TRUE);
+        case 'f':  return mini_parse_literal(c, v, "false", MINI_FALSE);
+        case 'n':  return mini_parse_literal(c, v, "null", MINI_NULL);
+        case '"':  return mini_parse_string(c, v);
+        default:   return mini_parse_number(c, v);
+    }
+}
+
+/* pushes the frame of the container at c->json, *frame becomes its offset */
+static int mini_parse_open(mini_context* c, size_t* frame) {
+    size_t mark = MARK_OPEN(c);
+    char kind = *c->json++;
+    mini_frame* f = (mini_frame*)mini_context_push(c, sizeof(mini_frame));
+    f->parent = *frame;
+    f->mark = mark;
+    f->kind = kind;
+    *frame = (char*)f - c->stack;
+    if(c->handler == NULL)
+        return MINI_PARSE_OK;
+    return mini_sax_start(c, kind == '[' ? c->handler->start_array : c->handler->start_object);
+}
+
+/* a member waits on the stack for its value, short keys are copied inline */
+static int mini_parse_key(mini_context* c) {
+    const char* key;
+    size_t len;
+    mini_member m;
+    int ret;
+    if(PEEK(c) != '\"')
+        return MINI_PARSE_MISS_KEY;
+    ret = c->insitu ? mini_parse_string_insitu(c, &key, &len) : mini_parse_string_raw(c, &key, &len);
+    if(ret != MINI_PARSE_OK)
+        return ret;
+    if(c->handler == NULL) {
+        if(c->insitu && len >= MINI_KEY_INLINE_SIZE) {
+            m.k.p = (char*)key;
+            m.klen = len;
+        }
+        else
+            mini_member_set_key(&m, key, len, c->arena);
+        mini_init(&m.v);
+        memcpy(mini_context_push(c, sizeof(mini_member)), &m, sizeof(mini_member));
+    }
+    else if(c->handler->key != NULL && c->handler->key(c->handler_user, key, len) != 0)
+        return MINI_PARSE_STOPPED;
+    mini_parse_whitespace(c);
+    if(PEEK(c) != ':')
+        return MINI_PARSE_MISS_COLON;
+    c->json++;
+    mini_parse_whitespace(c);
+    return MINI_PARSE_OK;
+}
+
+/* pops the innermost container, of size elements or members, into v; *frame becomes its parent */
+static int mini_parse_close(mini_context* c, size_t* frame, size_t size, mini_value* v) {
+    mini_frame f = *FRAME(c, *frame);
+    size_t bytes;
+    MARK_CLOSE(c, f.mark);
+    if(c->handler != NULL) {
+        c->top = *frame;
+        *frame = f.parent;
+        return mini_sax_end(c, f.kind == '[' ? c->handler->end_array : c->handler->end_object, size);
+    }
+    if(f.kind == '[') {
+        v->type = MINI_ARRAY;
+        v->u.a.size = v->u.a.capacity = size;
+        v->u.a.e = NULL;
+        if(size > 0) {
+            bytes = size * sizeof(mini_value);
+            memcpy(v->u.a.e = (mini_value*)mini_context_alloc(c, bytes), mini_context_pop(c, bytes), bytes);
+        }
+    }
+    else if(size == 0)
+        mini_init_object(v);
+    else {
+        /* members and index in one block */
+        v->type = MINI_OBJECT;
+        v->u.o.size = v->u.o.capacity = size;
+        v->u.o.m = (mini_member*)mini_context_alloc(c, mini_object_bytes(size));
+        bytes = size * sizeof(mini_member);
+        memcpy(v->u.o.m, mini_context_pop(c, bytes), bytes);
+        mini_object_rehash(v);
+    }
+    assert(c->top == *frame + sizeof(mini_frame));
+    c->top = *frame;
+    *frame = f.parent;
+    return MINI_PARSE_OK;
+}
+
+/* a failed parse frees what the open containers hold, a member waiting for its value too */
+static void mini_parse_unwind(mini_context* c, size_t frame) {
+    while(frame != MINI_NO_FRAME) {
+        mini_frame* f = FRAME(c, frame);
+        while(c->handler == NULL && c->top > frame + sizeof(mini_frame)) {
+            if(f->kind == '[')
+                mini_context_free_value(c, (mini_value*)mini_context_pop(c, sizeof(mini_value)));
+            else
+                mini_context_free_member(c, (mini_member*)mini_context_pop(c, sizeof(mini_member)));
+        }
+        c->top = frame;
+        frame = f->parent;
+    }
+}
+
+/*
+ * one loop for any nesting: containers live as frames on c->stack instead
+ * of C calls, and more than MINI_PARSE_MAX_DEPTH open ones fail the parse.
+ * kind and size describe the innermost container.
+ */
+static int mini_parse_value(mini_context* c, mini_value* v) {
+    size_t frame = MINI_NO_FRAME, depth = 0, size = 0;
+    char ch, kind = 0;
+    mini_value e;
+    int ret, closed;
+    for(;;) {
+        if(ATEND(c, c->json)) {
+            ret = MINI_PARSE_EXPECT_VALUE;
+            break;
+        }
+        ch = *c->json;
+        closed = 0;
+        if((ch == '[' || ch == '{') && (frame == MINI_NO_FRAME || !c->lazy)) {
+            if(depth == MINI_PARSE_MAX_DEPTH) {
+                ret = MINI_PARSE_TOO_DEEP;
+                break;
+            }
+            depth++;
+            if(frame != MINI_NO_FRAME)
+                FRAME(c, frame)->size = size;
+            if((ret = mini_parse_open(c, &frame)) != MINI_PARSE_OK)
+                break;
+            kind = ch;
+            size = 0;
+            mini_parse_whitespace(c);
+            if(PEEK(c) != CLOSER(kind)) {
+                if(kind == '{' && (ret = mini_parse_key(c)) != MINI_PARSE_OK)
+                    break;
+                continue;
+            }
+            c->json++;
+            closed = 1;
+        }
+        else {
+            mini_init(&e);
+            if(frame != MINI_NO_FRAME && ISLAZY(c, ch))
+                mini_parse_lazy_value(c, &e);
+            else if((ret = mini_parse_scalar(c, &e)) != MINI_PARSE_OK)
+                break;
+            if(frame == MINI_NO_FRAME) {
+                memcpy(v, &e, sizeof(mini_value));
+                return MINI_PARSE_OK;
+            }
+        }
+        /* e completes a value of the innermost container, each closing bracket one of its parent */
+        for(;;) {
+            if(closed) {
+                depth--;
+                if((ret = mini_parse_close(c, &frame, size, &e)) != MINI_PARSE_OK)
+                    break;
+                if(frame == MINI_NO_FRAME) {
+                    memcpy(v, &e, sizeof(mini_value));
+                    return MINI_PARSE_OK;
+                }
+                kind = FRAME(c, frame)->kind;
+                size = FRAME(c, frame)->size;
+            }
+            size++;
+            if(c->handler == NULL) {
+                if(kind == '[')
+                    memcpy(mini_context_push(c, sizeof(mini_value)), &e, sizeof(mini_value));
+                else
+                    memcpy(&((mini_member*)(c->stack + c->top) - 1)->v, &e, sizeof(mini_value));
+            }
+            mini_parse_whitespace(c);
+            if(PEEK(c) == ',') {
+                c->json++;
+                mini_parse_whitespace(c);
+                ret = kind == '{' ? mini_parse_key(c) : MINI_PARSE_OK;
+                break;
+            }
+            if(PEEK(c) != CLOSER(kind)) {
+                ret = kind == '[' ? MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET : MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+                break;
+            }
+            c->json++;
+            closed = 1;
+        }
+        if(ret != MINI_PARSE_OK)
+            break;
+    }
+    mini_parse_unwind(c, frame);
+    return ret;
+}
+
+static int mini_parse_root(mini_context* c, mini_value* v) {
+    int ret;
+    mini_init(v);
+    mini_parse_whitespace(c);
+    if ((ret = mini_parse_value(c, v)) == MINI_PARSE_OK) {
+        mini_parse_whitespace(c);
+        if (!ATEND(c, c->json)) {
+            mini_context_free_value(c, v);
+            ret = MINI_PARSE_ROOT_NOT_SINGULAR;
+        }
+    }
+    assert(c->top == 0);
+    return ret;
+}
+
+void mini_context_init(mini_context* c) {
+    assert(c != NULL);
+    c->stack = NULL;
+    c->size = c->top = 0;
+}
+
+void mini_context_free(mini_context* c) {
+    assert(c != NULL);
+    free(c->stack);
+    c->stack = NULL;
+    c->size = c->top = 0;
+}
+
+/* every field of one call starts over, the scratch stack of c is kept */
+static void mini_context_start(mini_context* c, const char* json, const char* end) {
+    c->json = json;
+    c->end = end;
+    c->top = 0;
+    c->arena = NULL;
+    c->handler = NULL;
+    c->sink = NULL;
+    c->insitu = 0;
+    c->lazy = 0;
+    c->marks_size = 0;
+    c->index = NULL;
+}
+
+static int mini_parse_text(mini_context* c, mini_value* v, const char* json, const char* end) {
+    assert(c != NULL && v != NULL);
+    mini_context_start(c, json, end);
+    return mini_parse_root(c, v);
+}
+
+/* builds one level of a lazy node in place, its text was validated by the parse */
+static void mini_lazy_load(mini_value* v) {
+    mini_context c;
+    int ret;
+    mini_context_init(&c);
+    mini_context_start(&c, v->u.l.json, v->u.l.end);
+    c.arena = &v->u.l.doc->arena;
+    c.lazy = 1;
+    c.doc = v->u.l.doc;
+    c.marks = v->u.l.doc->marks;
+    c.nmarks = v->u.l.doc->nmarks;
+    ret = mini_parse_value(&c, v);
+    assert(ret == MINI_PARSE_OK && c.top == 0);
+    (void)ret;
+    mini_context_free(&c);
+}
+
+int mini_context_parse(mini_context* c, mini_value* v, const char* json) {
+    assert(json != NULL);
+    return mini_parse_text(c, v, json, NULL);
+}
+
+int mini_context_parse_len(mini_context* c, mini_value* v, const char* json, size_t len) {
+    assert(json != NULL || len == 0);
+    return mini_parse_text(c, v, json, json + len);
+}
+
+int mini_context_parse_sax(mini_context* c, const char* json, const mini_handler* handler, void* user) {
+    mini_value v;
+    assert(c != NULL && json != NULL && handler != NULL);
+    mini_context_start(c, json, NULL);
+    c->handler = handler;
+    c->handler_user = user;
+    return mini_parse_root(c, &v);
+}
+
+int mini_parse(mini_value* v, const char* json) {
+    mini_context c;
+    int ret;
+    mini_context_init(&c);
+    ret = mini_context_parse(&c, v, json);
+    mini_context_free(&c);
+    return ret;
+}
+
+int mini_parse_len(mini_value* v, const char* json, size_t len) {
+    mini_context c;
+    int ret;
+    mini_context_init(&c);
+    ret = mini_context_parse_len(&c, v, json, len);
+    mini_context_free(&c);
+    return ret;
+}
+
+int mini_parse_sax(const char* json, const mini_handler* handler, void* user) {
+    mini_context c;
+    int ret;
+    mini_context_init(&c);
+    ret = mini_context_parse_sax(&c, json, handler, user);
+    mini_context_free(&c);
+    return ret;
+}
+
+/* without an index (json too long for it) the text is parsed as by mini_parse_len */
+static int mini_parse_indexed_root(mini_context* c, mini_value* v, const char* json, size_t len) {
+    size_t count;
+    int ret;
+    c->text = json;
+    c->index = mini_build_index(json, len, &count);
+    c->next = 0;
+    ret = mini_parse_root(c, v);
+    free((void*)c->index);
+    mini_context_free(c);
+    return ret;
+}
+
+int mini_parse_indexed(mini_value* v, const char* json, size_t len) {
+    mini_context c;
+    assert(v != NULL && (json != NULL || len == 0));
+    mini_context_init(&c);
+    mini_context_start(&c, json, json + len);
+    return mini_parse_indexed_root(&c, v, json, len);
+}
+
+int mini_parse_sax_indexed(const char* json, size_t len, const mini_handler* handler, void* user) {
+    mini_context c;
+    mini_value v;
+    assert((json != NULL || len == 0) && handler != NULL);
+    mini_context_init(&c);
+    mini_context_start(&c, json, json + len);
+    c.handler = handler;
+    c.handler_user = user;
+    return mini_parse_indexed_root(&c, &v, json, len);
+}
+
+static int mini_parse_document_text(mini_document* doc, const char* json, const char* end, int insitu) {
+    mini_context c;
+    int ret;
+    assert(doc != NULL);
+    arena_init(&doc->arena);
+    mini_context_init(&c);
+    mini_context_start(&c, json, end);
+    c.arena = &doc->arena;
+    c.insitu = insitu;
+    doc->marks = NULL;
+    doc->nmarks = 0;
+    if ((ret = mini_parse_root(&c, &doc->root)) != MINI_PARSE_OK)
+        arena_clear(&doc->arena);
+    mini_context_free(&c);
+    return ret;
+}
+
+int mini_parse_document(mini_document* doc, const char* json) {
+    assert(json != NULL);
+    return mini_parse_document_text(doc, json, NULL, 0);
+}
+
+int mini_parse_document_len(mini_document* doc, const char* json, size_t len) {
+    assert(json != NULL || len == 0);
+    return mini_parse_document_text(doc, json, json + len, 0);
+}
+
+int mini_parse_document_insitu(mini_document* doc, char* json, size_t len) {
+    assert(json != NULL || len == 0);
+    return mini_parse_document_text(doc, json, json + len, 1);
+}
+
+/* validated as a whole by a parse without nodes, then only the root level is built */
+static int mini_parse_lazy_text(mini_document* doc, const char* json, const char* end) {
+    static const mini_handler validator = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+    mini_context c;
+    mini_value v;
+    int ret;
+    assert(doc != NULL);
+    arena_init(&doc->arena);
+    mini_context_init(&c);
+    mini_context_start(&c, json, end);
+    c.handler = &validator;
+    c.handler_user = NULL;
+    c.marks_size = 64;
+    c.nmarks = 0;
+    c.marks = (const char**)malloc(c.marks_size * sizeof(const char*));
+    ret = mini_parse_root(&c, &v);
+    mini_context_free(&c);
+    if (ret != MINI_PARSE_OK) {
+        free((void*)c.marks);
+        mini_init(&doc->root);
+        doc->marks = NULL;
+        doc->nmarks = 0;
+        return ret;
+    }
+    doc->marks = c.marks;
+    doc->nmarks = c.nmarks;
+    doc->root.type = MINI_LAZY;
+    doc->root.u.l.json = mini_skip_whitespace(json, end);
+    doc->root.u.l.end = end;
+    doc->root.u.l.doc = doc;
+    mini_lazy_load(&doc->root);
+    return MINI_PARSE_OK;
+}
+
+int mini_parse_lazy(mini_document* doc, const char* json) {
+    assert(json != NULL);
+    return mini_parse_lazy_text(doc, json, NULL);
+}
+
+int mini_parse_lazy_len(mini_document* doc, const char* json, size_t len) {
+    assert(json != NULL || len == 0);
+    return mini_parse_lazy_text(doc, json, json + len);
+}
+
+void mini_free_document(mini_document* doc) {
+    assert(doc != NULL);
+    arena_clear(&doc->arena);
+    free((void*)doc->marks);
+    doc->marks = NULL;
+    doc->nmarks = 0;
+    mini_init(&doc->root);
+}
+
+/******************************************
+ *
+ *              push parser
+ *
+ ******************************************/
+#ifndef MINI_PUSH_BUFFER_INIT_SIZE
+#define MINI_PUSH_BUFFER_INIT_SIZE 64
+#endif
+
+/* what the innermost level (or the root) waits for */
+enum {
+    PUSH_VALUE,         /* root, after ',' in an array or after ':' */
+    PUSH_DONE,          /* root value complete */
+    PUSH_ARRAY_FIRST,   /* after '[' */
+    PUSH_ARRAY_AFTER,   /* after an element */
+    PUSH_OBJECT_FIRST,  /* after '{' */
+    PUSH_OBJECT_NEXT,   /* after ',' in an object */
+    PUSH_OBJECT_COLON,  /* after a key */
+    PUSH_OBJECT_AFTER   /* after a member value */
+};
+
+enum { PUSH_NONE, PUSH_STRING, PUSH_KEY, PUSH_NUMBER, PUSH_LITERAL };
+
+void mini_push_init(mini_push* p, const mini_handler* handler, void* user) {
+    assert(p != NULL && handler != NULL);
+    mini_context_init(&p->c);
+    mini_context_start(&p->c, NULL, NULL);
+    p->c.handler = handler;
+    p->c.handler_user = user;
+    p->levels = NULL;
+    p->depth = p->capacity = 0;
+    p->buf = NULL;
+    p->len = p->cap = 0;
+    p->state = PUSH_VALUE;
+    p->token = PUSH_NONE;
+    p->escape = 0;
+    p->error = MINI_PARSE_OK;
+}
+
+void mini_push_free(mini_push* p) {
+    assert(p != NULL);
+    mini_context_free(&p->c);
+    free(p->levels);
+    free(p->buf);
+    p->levels = NULL;
+    p->buf = NULL;
+}
+
+/* buf stays terminated, the token parsers need it */
+static void mini_push_append(mini_push* p, const char* s, size_t n) {
+    if(p->len + n >= p->cap) {
+        if(p->cap == 0)
+            p->cap = MINI_PUSH_BUFFER_INIT_SIZE;
+        while(p->len + n >= p->cap)
+            p->cap += p->cap >> 1;
+        p->buf = (char*)realloc(p->buf, p->cap);
+    }
+    memcpy(p->buf + p->len, s, n);
+    p->len += n;
+    p->buf[p->len] = '\0';
+}
+
+static mini_push_level* mini_push_top(mini_push* p) {
+    return p->depth != 0 ? &p->levels[p->depth - 1] : NULL;
+}
+
+/* a value was followed by something else than ',' or the closing bracket */
+static int mini_push_after_error(mini_push* p) {
+    const mini_push_level* l = mini_push_top(p);
+    if(l == NULL)
+        return MINI_PARSE_ROOT_NOT_SINGULAR;
+    return l->kind == '[' ? MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET : MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+}
+
+static int mini_push_open(mini_push* p, char kind) {
+    mini_push_level* l;
+    if(p->depth == MINI_PARSE_MAX_DEPTH)
+        return MINI_PARSE_TOO_DEEP;
+    if(p->depth == p->capacity) {
+        p->capacity = p->capacity == 0 ? 16 : p->capacity * 2;
+        p->levels = (mini_push_level*)realloc(p->levels, p->capacity * sizeof(mini_push_level));
+    }
+    l = &p->levels[p->depth++];
+    l->count = 0;
+    l->kind = kind;
+    if(kind == '[') {
+        l->state = PUSH_ARRAY_FIRST;
+        return mini_sax_start(&p->c, p->c.handler->start_array);
+    }
+    l->state = PUSH_OBJECT_FIRST;
+    return mini_sax_start(&p->c, p->c.handler->start_object);
+}
+
+static int mini_push_close(mini_push* p) {
+    const mini_push_level* l = &p->levels[--p->depth];
+    if(l->kind == '[')
+        return mini_sax_end(&p->c, p->c.handler->end_array, l->count);
+    return mini_sax_end(&p->c, p->c.handler->end_object, l->count);
+}
+
+/* the enclosing level moves past the value before it is read */
+static int mini_push_value(mini_push* p, char ch) {
+    mini_push_level* l = mini_push_top(p);
+    if(l == NULL)
+        p->state = PUSH_DONE;
+    else {
+        l->state = l->kind == '[' ? PUSH_ARRAY_AFTER : PUSH_OBJECT_AFTER;
+        l->count++;
+    }
+    switch(ch) {
+        case '[':
+        case '{': return mini_push_open(p, ch);
+        case '"': p->token = PUSH_STRING; p->escape = 0; return MINI_PARSE_OK;
+        case 't':
+        case 'f':
+        case 'n': p->token = PUSH_LITERAL; return MINI_PARSE_OK;
+        default:
+            if(ch != '-' && (ch < '0' || ch > '9'))
+                return MINI_PARSE_INVALID_VALUE;
+            p->token = PUSH_NUMBER;
+            return MINI_PARSE_OK;
+    }
+}
+
+/* one structural character outside any token */
+static int mini_push_char(mini_push* p, char ch) {
+    mini_push_level* l = mini_push_top(p);
+    switch(l != NULL ? l->state : p->state) {
+        case PUSH_DONE:
+            return MINI_PARSE_ROOT_NOT_SINGULAR;
+        case PUSH_ARRAY_FIRST:
+            if(ch == ']')
+                return mini_push_close(p);
+            return mini_push_value(p, ch);
+        case PUSH_ARRAY_AFTER:
+            if(ch == ',') {
+                l->state = PUSH_VALUE;
+                return MINI_PARSE_OK;
+            }
+            if(ch == ']')
+                return mini_push_close(p);
+            return MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+        case PUSH_OBJECT_FIRST:
+            if(ch == '}')
+                return mini_push_close(p);
+            /* fall through */
+        case PUSH_OBJECT_NEXT:
+            if(ch != '\"')
+                return MINI_PARSE_MISS_KEY;
+            l->state = PUSH_OBJECT_COLON;
+            p->token = PUSH_KEY;
+            p->escape = 0;
+            return MINI_PARSE_OK;
+        case PUSH_OBJECT_COLON:
+            if(ch != ':')
+                return MINI_PARSE_MISS_COLON;
+            l->state = PUSH_VALUE;
+            return MINI_PARSE_OK;
+        case PUSH_OBJECT_AFTER:
+            if(ch == ',') {
+                l->state = PUSH_OBJECT_NEXT;
+                return MINI_PARSE_OK;
+            }
+            if(ch == '}')
+                return mini_push_close(p);
+            return MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+        default:
+            return mini_push_value(p, ch);
+    }
+}
+
+/*
+ * parses a whole token. text is either buf or the chunk itself: then the
+ * byte at text + n ends the token and stops the parsers before it.
+ */
+static int mini_push_token(mini_push* p, const char* text, size_t n) {
+    static const char* const literals[] = { "null", "false", "true" };
+    static const mini_type types[] = { MINI_NULL, MINI_FALSE, MINI_TRUE };
+    const mini_handler* h = p->c.handler;
+    const char* s;
+    size_t len, i;
+    mini_value v;
+    int token = p->token, ret;
+    p->token = PUSH_NONE;
+    p->len = 0;
+    switch(token) {
+        case PUSH_STRING:
+        case PUSH_KEY:
+            p->c.json = text;
+            p->c.end = text + n;
+            if((ret = mini_parse_string_raw(&p->c, &s, &len)) != MINI_PARSE_OK)
+                return ret;
+            if(token == PUSH_STRING)
+                return h->string == NULL ? MINI_PARSE_OK : SAX_EVENT(h->string(p->c.handler_user, s, len));
+            return h->key == NULL ? MINI_PARSE_OK : SAX_EVENT(h->key(p->c.handler_user, s, len));
+        case PUSH_NUMBER:
+            if((s = mini_read_number(text, &v.u.n)) == NULL)
+                return MINI_PARSE_INVALID_VALUE;
+            if(v.u.n.kind == MINI_NUMBER_DOUBLE && (v.u.n.v.d == HUGE_VAL || v.u.n.v.d == -HUGE_VAL))
+                return MINI_PARSE_NUMBER_TOO_BIG;
+            v.type = MINI_NUMBER;
+            len = s - text;
+            break;
+        default:
+            i = text[0] == 'n' ? 0 : text[0] == 'f' ? 1 : 2;
+            len = strlen(literals[i]);
+            if(n < len || memcmp(text, literals[i], len) != 0)
+                return MINI_PARSE_INVALID_VALUE;
+            v.type = types[i];
+            break;
+    }
+    if((ret = mini_sax_scalar(&p->c, &v)) != MINI_PARSE_OK)
+        return ret;
+    /* "0123" or "truex": the rest is what follows the value */
+    return len < n ? mini_push_after_error(p) : MINI_PARSE_OK;
+}
+
+/* end of the token that starts at or before s, NULL if the chunk ends first */
+static const char* mini_push_token_end(mini_push* p, const char* s, const char* end) {
+    switch(p->token) {
+        case PUSH_NUMBER:
+            while(s < end && ISNUMBERCHAR(*s))
+                s++;
+            break;
+        case PUSH_LITERAL:
+            while(s < end && *s >= 'a' && *s <= 'z')
+                s++;
+            break;
+        default:
+            for(; s < end; s++) {
+                if(p->escape)
+                    p->escape = 0;
+                else if(*s == '\\')
+                    p->escape = 1;
+                else if(*s == '\"')
+                    return s + 1;
+            }
+            break;
+    }
+    return s < end ? s : NULL;
+}
+
+/* continues the token at s, fresh when it starts there; returns where the scan stopped */
+static const char* mini_push_scan(mini_push* p, const char* s, const char* end, int fresh) {
+    const char* e = mini_push_token_end(p, fresh ? s + 1 : s, end);
+    if(e == NULL) {
+        mini_push_append(p, s, end - s);
+        return end;
+    }
+    if(fresh)
+        p->error = mini_push_token(p, s, e - s);
+    else {
+        mini_push_append(p, s, e - s);
+        p->error = mini_push_token(p, p->buf, p->len);
+    }
+    return e;
+}
+
+int mini_push_feed(mini_push* p, const char* data, size_t len) {
+    const char* end = data + len;
+    assert(p != NULL && (data != NULL || len == 0));
+    if(p->error == MINI_PARSE_OK && p->token != PUSH_NONE && len != 0)
+        data = mini_push_scan(p, data, end, 0);
+    while(p->error == MINI_PARSE_OK && data < end) {
+        if(ISWHITESPACE(*data))
+            data++;
+        else if((p->error = mini_push_char(p, *data)) == MINI_PARSE_OK)
+            data = p->token != PUSH_NONE ? mini_push_scan(p, data, end, 1) : data + 1;
+    }
+    return p->error;
+}
+
+int mini_push_finish(mini_push* p) {
+    const mini_push_level* l;
+    assert(p != NULL);
+    if(p->error != MINI_PARSE_OK)
+        return p->error;
+    if(p->token != PUSH_NONE && (p->error = mini_push_token(p, p->buf, p->len)) != MINI_PARSE_OK)
+        return p->error;
+    if((l = mini_push_top(p)) == NULL)
+        return p->error = p->state == PUSH_DONE ? MINI_PARSE_OK : MINI_PARSE_EXPECT_VALUE;
+    switch(l->state) {
+        case PUSH_ARRAY_AFTER:   return p->error = MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+        case PUSH_OBJECT_FIRST:
+        case PUSH_OBJECT_NEXT:   return p->error = MINI_PARSE_MISS_KEY;
+        case PUSH_OBJECT_COLON:  return p->error = MINI_PARSE_MISS_COLON;
+        case PUSH_OBJECT_AFTER:  return p->error = MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+        default:                 return p->error = MINI_PARSE_EXPECT_VALUE;
+    }
+}
+
+/* a finished value goes to root, the open array or the object under the pending key */
+static int mini_builder_put(mini_builder* b, mini_value* v) {
+    mini_value* top;
+    if(b->top == 0) {
+        mini_move(&b->root, v);
+        return 0;
+    }
+    top = &b->stack[b->top - 1];
+    if(top->type == MINI_ARRAY) {
+        mini_move_value_to_array(top, v);
+        return 0;
+    }
+    mini_move_value_to_object(top - 1, top, v);
+    b->top--;
+    return 0;
+}
+
+static int mini_builder_push(mini_builder* b, const mini_value* v) {
+    if(b->top == b->size) {
+        b->size = b->size == 0 ? 16 : b->size * 2;
+        b->stack = (mini_value*)realloc(b->stack, b->size * sizeof(mini_value));
+    }
+    memcpy(&b->stack[b->top++], v, sizeof(mini_value));
+    return 0;
+}
+
+static int mini_builder_null(void* user) {
+    mini_value v;
+    mini_init(&v);
+    return mini_builder_put((mini_builder*)user, &v);
+}
+
+static int mini_builder_boolean(void* user, int b) {
+    mini_value v;
+    v.type = b ? MINI_TRUE : MINI_FALSE;
+    return mini_builder_put((mini_builder*)user, &v);
+}
+
+static int mini_builder_number(void* user, const mini_number* n) {
+    mini_value v;
+    v.type = MINI_NUMBER;
+    v.u.n = *n;
+    return mini_builder_put((mini_builder*)user, &v);
+}
+
+static int mini_builder_string(void* user, const char* s, size_t len) {
+    mini_value v;
+    mini_init(&v);
+    mini_set_string(&v, s, len);
+    return mini_builder_put((mini_builder*)user, &v);
+}
+
+static int mini_builder_key(void* user, const char* s, size_t len) {
+    mini_value v;
+    mini_init(&v);
+    mini_set_string(&v, s, len);
+    return mini_builder_push((mini_builder*)user, &v);
+}
+
+static int mini_builder_start_object(void* user) {
+    mini_value v;
+    mini_init_object(&v);
+    return mini_builder_push((mini_builder*)user, &v);
+}
+
+static int mini_builder_start_array(void* user) {
+    mini_value v;
+    mini_init_array(&v);
+    return mini_builder_push((mini_builder*)user, &v);
+}
+
+static int mini_builder_end(void* user, size_t size) {
+    mini_builder* b = (mini_builder*)user;
+    mini_value v;
+    (void)size;
+    memcpy(&v, &b->stack[--b->top], sizeof(mini_value));
+    return mini_builder_put(b, &v);
+}
+
+const mini_handler mini_builder_handler = {
+    mini_builder_null, mini_builder_boolean, mini_builder_number, mini_builder_string,
+    mini_builder_start_object, mini_builder_key, mini_builder_end,
+    mini_builder_start_array, mini_builder_end
+};
+
+void mini_builder_init(mini_builder* b) {
+    assert(b != NULL);
+    mini_init(&b->root);
+    b->stack = NULL;
+    b->top = b->size = 0;
+}
+
+void mini_builder_free(mini_builder* b) {
+    assert(b != NULL);
+    while(b->top > 0)
+        mini_free(&b->stack[--b->top]);
+    free(b->stack);
+    b->stack = NULL;
+    b->size = 0;
+    mini_free(&b->root);
+}
+
+/******************************************
+ *
+ *              tree walk
+ *
+ ******************************************/
+#define ISCONTAINER(v)      ((v)->type == MINI_ARRAY || (v)->type == MINI_OBJECT)
+#define CHILDREN(v)         ((v)->type == MINI_ARRAY ? (v)->u.a.size : (v)->u.o.size)
+#define CHILD(x, i)         ((x)->type == MINI_ARRAY ? &(x)->u.a.e[i] : &(x)->u.o.m[i].v)
+
+/* an open container of a walk and its next child */
+typedef struct {
+    mini_value* v;
+    mini_value* copy;  /* mini_copy only: the container being filled from v */
+    size_t i;
+}mini_visit;
+
+/* the containers from the root down, on the heap only when the value is deep */
+typedef struct {
+    mini_visit* visits;
+    size_t top, size;
+    mini_visit local[MINI_WALK_LOCAL_SIZE];
+}mini_walk;
+
+static void mini_walk_init(mini_walk* w) {
+    w->visits = w->local;
+    w->top = 0;
+    w->size = MINI_WALK_LOCAL_SIZE;
+}
+
+static void mini_walk_push(mini_walk* w, const mini_value* v) {
+    if(w->top == w->size) {
+        w->size *= 2;
+        if(w->visits == w->local)
+            w->visits = (mini_visit*)memcpy(malloc(w->size * sizeof(mini_visit)), w->local, sizeof(w->local));
+        else
+            w->visits = (mini_visit*)realloc(w->visits, w->size * sizeof(mini_visit));
+    }
+    w->visits[w->top].v = (mini_value*)v;
+    w->visits[w->top].i = 0;
+    w->top++;
+}
+
+static void mini_walk_free(mini_walk* w) {
+    if(w->visits != w->local)
+        free(w->visits);
+}
+
+#define MINI_FREED          ((size_t)-1)
+
+/*
+ * frees the children of container p from i on, up to its first container
+ * child, and returns that index. A key goes with its member. Without one
+ * p is freed as well and MINI_FREED comes back.
+ */
+static size_t mini_free_leaves(mini_value* p, size_t i) {
+    mini_value* v;
+    if(p->type == MINI_ARRAY) {
+        mini_value* e = p->u.a.e;
+        for(; i < p->u.a.size; i++) {
+            v = &e[i];
+            if(ISCONTAINER(v))
+                return i;
+            if(v->type == MINI_STRING)
+                lfree(v->u.s.s);
+        }
+        lfree(e);
+    }
+    else {
+        mini_member* m = p->u.o.m;
+        for(; i < p->u.o.size; i++) {
+            if(m[i].klen >= MINI_KEY_INLINE_SIZE)
+                lfree(m[i].k.p);
+            v = &m[i].v;
+            if(ISCONTAINER(v))
+                return i;
+            if(v->type == MINI_STRING)
+                lfree(v->u.s.s);
+        }
+        lfree(m);
+    }
+    p->type = MINI_NULL;
+    return MINI_FREED;
+}
+
+/*
+ * children first, a container after its last one. Only containers that
+ * hold containers are visited, each at the child being freed.
+ */
+void mini_free(mini_value* v) {
+    mini_walk w;
+    size_t i;
+    assert(v != NULL);
+    if(v->type == MINI_STRING)
+        lfree(v->u.s.s);
+    if(!ISCONTAINER(v)) {
+        v->type = MINI_NULL;
+        return;
+    }
+    if((i = mini_free_leaves(v, 0)) == MINI_FREED)
+        return;
+    mini_walk_init(&w);
+    mini_walk_push(&w, v);
+    w.visits[0].i = i;
+    while(w.top > 0) {
+        mini_visit* t = &w.visits[w.top - 1];
+        v = CHILD(t->v, t->i);
+        if((i = mini_free_leaves(v, 0)) != MINI_FREED) {
+            mini_walk_push(&w, v);
+            w.visits[w.top - 1].i = i;
+            continue;
+        }
+        /* v is gone, its parents go on after it */
+        while(w.top > 0) {
+            t = &w.visits[w.top - 1];
+            if((t->i = mini_free_leaves(t->v, t->i + 1)) != MINI_FREED)
+                break;
+            w.top--;
+        }
+    }
+    mini_walk_free(&w);
+}
+
+/*
+ * one node of src: a string or a container buffer is allocated, object
+ * keys and index come along. The children of a container are left to the
+ * caller, who fills every one of them.
+ */
+static void mini_copy_node(mini_value* dst, const mini_value* src) {
+    size_t i;
+    switch(src->type) {
+        case MINI_STRING:
+            mini_init(dst);
+            mini_set_string(dst, src->u.s.s, src->u.s.len);
+            break;
+        case MINI_ARRAY:
+            dst->type = MINI_ARRAY;
+            dst->u.a.size = dst->u.a.capacity = src->u.a.size;
+            dst->u.a.e = src->u.a.size > 0 ? (mini_value*)lmalloc(sizeof(mini_value) * src->u.a.size) : NULL;
+            break;
+        case MINI_OBJECT:
+            mini_init_object(dst);
+            if(src->u.o.size == 0)
+                break;
+            mini_reserve_object(dst, src->u.o.size);
+            for(i = 0; i < src->u.o.size; i++) {
+                const mini_member* m = &src->u.o.m[i];
+                mini_member_set_key(&dst->u.o.m[i], MEMBER_KEY(m), m->klen, NULL);
+            }
+            dst->u.o.size = src->u.o.size;
+            /* same index size: the slots can be reused as they are */
+            if(mini_index_capacity(src->u.o.capacity) == mini_index_capacity(dst->u.o.capacity))
+                memcpy(mini_object_index(dst), mini_object_index(src), mini_index_capacity(dst->u.o.capacity) * sizeof(mini_slot));
+            else
+                mini_object_rehash(dst);
+            break;
+        default:
+            memcpy(dst, src, sizeof(mini_value));
+            break;
+    }
+}
+
+/*
+ * depth-first without recursion, as mini_generate_value walks. The copy is
+ * built aside, so src may live inside dst.
+ */
+void mini_copy(mini_value* dst, const mini_value* src) {
+    mini_value copy;
+    mini_walk w;
+    assert(dst != NULL && src != NULL && dst != src);
+    LOAD(src);
+    mini_copy_node(&copy, src);
+    if(ISCONTAINER(src) && CHILDREN(src) > 0) {
+        mini_walk_init(&w);
+        mini_walk_push(&w, src);
+        w.visits[0].copy = &copy;
+        while(w.top > 0) {
+            mini_visit* t = &w.visits[w.top - 1];
+            const mini_value* p = t->v;
+            mini_value* v = NULL;
+            size_t i, size = CHILDREN(p);
+            /* leaves are copied in place, the first open container child is descended into */
+            for(i = t->i; i < size; i++) {
+                v = CHILD(p, i);
+                LOAD(v);
+                mini_copy_node(CHILD(t->copy, i), v);
+                if(ISCONTAINER(v) && CHILDREN(v) > 0)
+                    break;
+            }
+            if(i == size)
+                w.top--;
+            else {
+                mini_value* copy_v = CHILD(t->copy, i);
+                t->i = i + 1;
+                mini_walk_push(&w, v);  /* t may move */
+                w.visits[w.top - 1].copy = copy_v;
+            }
+        }
+        mini_walk_free(&w);
+    }
+    mini_free(dst);
+    memcpy(dst, &copy, sizeof(mini_value));
+}
+
+// for deep copy
+mini_value* mini_backup(mini_value* v){
+    mini_value* ret = (mini_value*)malloc(sizeof(mini_value));
+    mini_init(ret);
+    mini_copy(ret, v);
+    return ret;
+}
+
+mini_type mini_get_type(const mini_value* v) {
+    assert(v != NULL);
+    return v->type;
+}
+
+void mini_set_type(mini_value* v, mini_type type) {
+    assert(v != NULL);
+    v->type = type;
+}
+
+int mini_get_boolean(const mini_value* v) {
+    assert(v != NULL && (v->type == MINI_TRUE || v->type == MINI_FALSE));
+    return v->type == MINI_TRUE;
+}
+
+void mini_set_boolean(mini_value* v, int b) {
+    mini_free(v);
+    v->type = b ? MINI_TRUE : MINI_FALSE;
+}
+
+double mini_get_number(const mini_value* v) {
+    assert(v != NULL && v->type == MINI_NUMBER);
+    switch(v->u.n.kind) {
+        case MINI_NUMBER_INT64:  return (double)v->u.n.v.i;
+        case MINI_NUMBER_UINT64: return (double)v->u.n.v.u;
+        default:                 return v->u.n.v.d;
+    }
+}
+
+void mini_set_number(mini_value* v, double n) {
+    mini_free(v);
+    v->u.n.v.d = n;
+    v->u.n.kind = MINI_NUMBER_DOUBLE;
+    v->type = MINI_NUMBER;
+}
+
+mini_number_kind mini_get_number_kind(const mini_value* v) {
+    assert(v != NULL && v->type == MINI_NUMBER);
+    return v->u.n.kind;
+}
+
+int64_t mini_get_int64(const mini_value* v) {
+    assert(v != NULL && v->type == MINI_NUMBER);
+    assert(v->u.n.kind == MINI_NUMBER_INT64 || (v->u.n.kind == MINI_NUMBER_UINT64 && v->u.n.v.u <= INT64_MAX));
+    return v->u.n.v.i;
+}
+
+void mini_set_int64(mini_value* v, int64_t i) {
+    mini_free(v);
+    v->u.n.v.i = i;
+    v->u.n.kind = MINI_NUMBER_INT64;
+    v->type = MINI_NUMBER;
+}
+
+uint64_t mini_get_uint64(const mini_value* v) {
+    assert(v != NULL && v->type == MINI_NUMBER);
+    assert(v->u.n.kind == MINI_NUMBER_UINT64 || (v->u.n.kind == MINI_NUMBER_INT64 && v->u.n.v.i >= 0));
+    return v->u.n.v.u;
+}
+
+void mini_set_uint64(mini_value* v, uint64_t u) {
+    mini_free(v);
+    v->u.n.v.u = u;
+    v->u.n.kind = MINI_NUMBER_UINT64;
+    v->type = MINI_NUMBER;
+}
+
+const char* mini_get_string(const mini_value* v) {
+    assert(v != NULL && v->type == MINI_STRING);
+    return v->u.s.s;
+}
+
+size_t mini_get_string_length(const mini_value* v) {
+    assert(v != NULL && v->type == MINI_STRING);
+    return v->u.s.len;
+}
+
+void mini_set_string(mini_value* v, const char* s, size_t len) {
+    assert(v != NULL && (s != NULL || len == 0));
+    mini_free(v);
+    v->u.s.s = (char*)lmalloc(len + 1);
+    memcpy(v->u.s.s, s, len);
+    v->u.s.s[len] = '\0';
+    v->u.s.len = len;
+    v->type = MINI_STRING;
+}
+
+void mini_init_array(mini_value* v) {
+    assert(v != NULL);
+    v->type = MINI_ARRAY;
+    v->u.a.e = NULL;
+    v->u.a.size = v->u.a.capacity = 0;
+}
+
+size_t mini_get_array_size(const mini_value* v) {
+    assert(v != NULL && v->type == MINI_ARRAY);
+    return v->u.a.size;
+}
+
+mini_value* mini_get_array_element(const mini_value* v, size_t index) {
+    assert(v != NULL && v->type == MINI_ARRAY);
+    assert(index < v->u.a.size);
+    LOAD(&v->u.a.e[index]);
+    return &v->u.a.e[index];
+}
+
+size_t mini_get_array_capacity(const mini_value* v) {
+    assert(v != NULL && v->type == MINI_ARRAY);
+    return v->u.a.capacity;
+}
+
+void mini_reserve_array(mini_value* v, size_t capacity) {
+    assert(v != NULL && v->type == MINI_ARRAY);
+    if(v->u.a.capacity < capacity) {
+        v->u.a.capacity = capacity;
+        v->u.a.e = (mini_value*)lrealloc(v->u.a.e, capacity * sizeof(mini_value));
+    }
+}
+
+void mini_shrink_array(mini_value* v) {
+    assert(v != NULL && v->type == MINI_ARRAY);
+    if(v->u.a.capacity > v->u.a.size) {
+        v->u.a.capacity = v->u.a.size;
+        if(v->u.a.size == 0) {
+            lfree(v->u.a.e);
+            v->u.a.e = NULL;
+        }
+        else
+            v->u.a.e = (mini_value*)lrealloc(v->u.a.e, v->u.a.size * sizeof(mini_value));
+    }
+}
+
+void mini_init_object(mini_value* v) {
+    assert(v != NULL);
+    v->type = MINI_OBJECT;
+    v->u.o.m = NULL;
+    v->u.o.size = v->u.o.capacity = 0;
+}
+
+size_t mini_get_object_size(const mini_value* v) {
+    assert(v != NULL && v->type == MINI_OBJECT);
+    return v->u.o.size;
+}
+
+mini_value* mini_get_object_value(const mini_value* v, const char* key) {
+    assert(key != NULL);
+    return mini_find_object_value(v, key, strlen(key));
+}
+
+size_t mini_find_object_index(const mini_value* v, const char* key, size_t klen) {
+    assert(v != NULL && v->type == MINI_OBJECT && key != NULL);
+    return mini_object_find(v, key, klen);
+}
+
+mini_value* mini_find_object_value(const mini_value* v, const char* key, size_t klen) {
+    size_t i = mini_find_object_index(v, key, klen);
+    if(i == MINI_KEY_NOT_EXIST)
+        return NULL;
+    LOAD(&v->u.o.m[i].v);
+    return &v->u.o.m[i].v;
+}
+
+const char* mini_get_object_key(const mini_value* v, size_t index) {
+    assert(v != NULL && v->type == MINI_OBJECT);
+    assert(index < v->u.o.size);
+    return MEMBER_KEY(&v->u.o.m[index]);
+}
+
+size_t mini_get_object_key_length(const mini_value* v, size_t index) {
+    assert(v != NULL && v->type == MINI_OBJECT);
+    assert(index < v->u.o.size);
+    return v->u.o.m[index].klen;
+}
+
+mini_value* mini_get_object_value_at(const mini_value* v, size_t index) {
+    assert(v != NULL && v->type == MINI_OBJECT);
+    assert(index < v->u.o.size);
+    LOAD(&v->u.o.m[index].v);
+    return &v->u.o.m[index].v;
+}
+
+size_t mini_get_object_capacity(const mini_value* v) {
+    assert(v != NULL && v->type == MINI_OBJECT);
+    return v->u.o.capacity;
+}
+
+void mini_reserve_object(mini_value* v, size_t capacity) {
+    assert(v != NULL && v->type == MINI_OBJECT);
+    if(v->u.o.capacity < capacity) {
+        v->u.o.capacity = capacity;
+        v->u.o.m = (mini_member*)lrealloc(v->u.o.m, mini_object_bytes(capacity));
+        mini_object_rehash(v);
+    }
+}
+
+/* hands a full stack to the sink, the stack is reused even when the sink fails */
+static void mini_generate_flush(mini_context* c, size_t limit) {
+    if(c->sink == NULL || c->top < limit || c->top == 0)
+        return;
+    if(!c->sink_failed && c->sink(c->sink_user, c->stack, c->top) != 0)
+        c->sink_failed = 1;
+    c->top = 0;
+}
+
+static void mini_generate_string(mini_context* c, const char* s, size_t len) {
+    static const char hex_digits[] = {'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'};
+    size_t i = 0, end, size;
+    char* head, *p;
+    assert(s != NULL);
+    PUTC(c, '"');
+    /* a streamed string is escaped a chunk at a time */
+    while(i < len) {
+        end = c->sink != NULL && len - i > MINI_GENERATE_CHUNK_SIZE ? i + MINI_GENERATE_CHUNK_SIZE : len;
+        p = head = mini_context_push(c, size = (end - i) * 6); /* "\u00xx ... " */
+        for(; i < end; i++){
+            unsigned char ch = (unsigned char)s[i];
+            switch(ch) {
+                case '\"' : *p++ = '\\', *p++ = '\"';break;
+                case '\\' : *p++ = '\\'; *p++ = '\\'; break;
+                case '\b' : *p++ = '\\'; *p++ = 'b';  break;
+                case '\f' : *p++ = '\\'; *p++ = 'f';  break;
+                case '\n' : *p++ = '\\'; *p++ = 'n';  break;
+                case '\r' : *p++ = '\\'; *p++ = 'r';  break;
+                case '\t' : *p++ = '\\'; *p++ = 't';  break;
+                default :
+                    if( ch < 0x20) {
+                        *p++ = '\\'; *p++ = 'u'; *p++ = '0'; *p++ = '0';
+                        *p++ = hex_digits[ch >> 4];
+                        *p++ = hex_digits[ch & 15];
+                    }
+                    else
+                        *p++ = s[i];
+            }
+        }
+        c->top -= size - (p - head);
+        mini_generate_flush(c, MINI_GENERATE_CHUNK_SIZE);
+    }
+    PUTC(c, '"');
+}
+
+/* scalars and empty containers, the rest is opened and closed by mini_generate_value */
+static void mini_generate_leaf(mini_context* c, const mini_value* v) {
+    size_t len;
+    switch(v->type) {
+        case MINI_NULL : PUTS(c, "null", 4);break;
+        case MINI_TRUE : PUTS(c, "true", 4);break;
+        case MINI_FALSE : PUTS(c, "false", 5);break;
+        case MINI_NUMBER ://整数用数位循环, 浮点数用Grisu2输出最短的文本
+                if(v->u.n.kind == MINI_NUMBER_INT64)
+                    len = mini_write_int64(mini_context_push(c, 32), v->u.n.v.i);
+                else if(v->u.n.kind == MINI_NUMBER_UINT64)
+                    len = mini_write_uint64(mini_context_push(c, 32), v->u.n.v.u);
+                else if(isfinite(v->u.n.v.d))
+                    len = mini_write_double(mini_context_push(c, 32), v->u.n.v.d);
+                else { /* json has no NaN or infinity */
+                    PUTS(c, "null", 4);
+                    break;
+                }
+                c->top -= 32 - len;
+                break;
+        case MINI_STRING : mini_generate_string(c, v->u.s.s, v->u.s.len); break;
+        case MINI_ARRAY : PUTS(c, "[]", 2); break;
+        case MINI_OBJECT : PUTS(c, "{}", 2); break;
+    }
+}
+
+/* depth-first without recursion, the open containers are kept on a walk */
+static void mini_generate_value(mini_context* c, const mini_value* v) {
+    mini_walk w;
+    LOAD(v);
+    if(!ISCONTAINER(v) || CHILDREN(v) == 0) {
+        mini_generate_leaf(c, v);
+        mini_generate_flush(c, MINI_GENERATE_CHUNK_SIZE);
+        return;
+    }
+    mini_walk_init(&w);
+    PUTC(c, v->type == MINI_ARRAY ? '[' : '{');
+    mini_walk_push(&w, v);
+    while(w.top > 0 && !c->sink_failed) {
+        mini_visit* t = &w.visits[w.top - 1];
+        const mini_value* p = t->v;
+        size_t i, size = CHILDREN(p);
+        /* leaves are written in place, the first open container child is descended into */
+        for(i = t->i, v = NULL; i < size; i++) {
+            if(i > 0) PUTC(c, ',');
+            if(p->type == MINI_OBJECT) {
+                const mini_member* m = &p->u.o.m[i];
+                mini_generate_string(c, MEMBER_KEY(m), m->klen);
+                PUTC(c, ':');
+            }
+            v = CHILD(p, i);
+            LOAD(v);
+            if(ISCONTAINER(v) && CHILDREN(v) > 0)
+                break;
+            mini_generate_leaf(c, v);
+            mini_generate_flush(c, MINI_GENERATE_CHUNK_SIZE);
+        }
+        if(i == size) {
+            PUTC(c, p->type == MINI_ARRAY ? ']' : '}');
+            w.top--;
+        }
+        else {
+            t->i = i + 1;
+            PUTC(c, v->type == MINI_ARRAY ? '[' : '{');
+            mini_walk_push(&w, v);
+        }
+        mini_generate_flush(c, MINI_GENERATE_CHUNK_SIZE);
+    }
+    mini_walk_free(&w);
+}
+
+/* the text is left at the bottom of the context stack, which goes to the caller */
+int mini_generate(const mini_value* v, char** json, size_t* length) {
+    mini_context c;
+    const char* text;
+    int ret;
+    assert(json != NULL);
+    mini_context_init(&c);
+    c.stack = (char*)malloc(c.size = MINI_PARSE_BUILDER_INIT_SIZE);
+    ret = mini_context_generate(&c, v, &text, length);
+    *json = c.stack;
+    return ret;
+}
+
+int mini_generate_to(const mini_value* v, mini_sink sink, void* user) {
+    mini_context c;
+    int ret;
+    mini_context_init(&c);
+    ret = mini_context_generate_to(&c, v, sink, user);
+    mini_context_free(&c);
+    return ret;
+}
+
+/* the text is left on the scratch stack of c */
+int mini_context_generate(mini_context* c, const mini_value* v, const char** json, size_t* length) {
+    assert(c != NULL && v != NULL && json != NULL);
+    mini_context_start(c, NULL, NULL);
+    c->sink_failed = 0;
+    mini_generate_value(c, v);
+    if(length)
+        *length = c->top;
+    PUTC(c, '\0');
+    *json = c->stack;
+    return MINI_GENERATE_OK;
+}
+
+int mini_context_generate_to(mini_context* c, const mini_value* v, mini_sink sink, void* user) {
+    assert(c != NULL && v != NULL && sink != NULL);
+    mini_context_start(c, NULL, NULL);
+    c->sink = sink;
+    c->sink_user = user;
+    c->sink_failed = 0;
+    mini_generate_value(c, v);
+    mini_generate_flush(c, 0);
+    return c->sink_failed ? MINI_GENERATE_SINK_ERROR : MINI_GENERATE_OK;
+}
+
+int mini_file_sink(void* fp, const char* data, size_t len) {
+    return fwrite(data, 1, len, (FILE*)fp) != len;
+}
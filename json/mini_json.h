@@ -1,96 +1,293 @@
-#ifndef _MINI_JSON_H__
-#define _MINI_JSON_H__
-
-#include <stddef.h> /* size_t */
-#include "../map/map.h"
-
-typedef enum { MINI_NULL, MINI_FALSE, MINI_TRUE, MINI_NUMBER, MINI_STRING, MINI_ARRAY, MINI_OBJECT } mini_type;
-
-typedef struct mini_value mini_value;
-
-struct mini_value {
-    union {
-        struct { Map* pmap; size_t size; }o; /* object */
-        struct { mini_value* e; size_t size; }a; /* array */
-        struct { char* s; size_t len; }s;  /* string: null-terminated string, string length */
-        double n;                          /* number */
-    }u;
-    mini_type type;
-};
-
-typedef struct {
-    const char* json;
-    char* stack;
-    size_t size, top;
-}mini_context;
-
-enum {
-    MINI_PARSE_OK = 0,
-    MINI_PARSE_EXPECT_VALUE,
-    MINI_PARSE_INVALID_VALUE,
-    MINI_PARSE_ROOT_NOT_SINGULAR,
-    MINI_PARSE_NUMBER_TOO_BIG,
-    MINI_PARSE_MISS_QUOTATION_MARK,
-    MINI_PARSE_INVALID_STRING_ESCAPE,
-    MINI_PARSE_INVALID_STRING_CHAR,
-    MINI_PARSE_INVALID_UNICODE_HEX,
-    MINI_PARSE_INVALID_UNICODE_SURROGATE,
-    MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET,
-    MINI_PARSE_MISS_KEY,
-    MINI_PARSE_MISS_COLON,
-    MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET,
-    MINI_GENERATE_OK
-};
-
-/*****************************************
- *
- *              interface
- *
- *****************************************/
-void mini_show_value(const mini_value* v);
-void mini_add_value_to_array(mini_value* arr, mini_value* v);
-void mini_add_value_to_object(mini_value* obj, mini_value* key, mini_value* value);
-
-int mini_parse(mini_value* v, const char* json);
-int mini_generate(const mini_value* v, char** json, size_t* length);
-void mini_free(mini_value* v);
-//for deep copy
-mini_value* mini_backup(mini_value* v);
-
-
-#define mini_init(v) do { (v)->type = MINI_NULL; } while(0)
-
-mini_type mini_get_type(const mini_value* v);
-void mini_set_type(mini_value* v, mini_type type);
-
-#define mini_set_null(v) mini_free(v)
-
-int mini_get_boolean(const mini_value* v);
-void mini_set_boolean(mini_value* v, int b);
-
-double mini_get_number(const mini_value* v);
-void mini_set_number(mini_value* v, double n);
-
-const char* mini_get_string(const mini_value* v);
-size_t mini_get_string_length(const mini_value* v);
-void mini_set_string(mini_value* v, const char* s, size_t len);
-
-void mini_init_array(mini_value* v);
-size_t mini_get_array_size(const mini_value* v);
-mini_value* mini_get_array_element(const mini_value* v, size_t index);
-
-void mini_init_object(mini_value* v);
-size_t mini_get_object_size(const mini_value* v);
-mini_value* mini_get_object_value(const mini_value* v, const char* key);
-
-/******************************************
- *
- *              map
- * 
- ******************************************/
-Map* get_map(const mini_value* v);
-Item* new_item(const char* key, void *value);
-void inner_clear(void *p);
-void show_item(void *data);
-void mini_traverse(mini_context* c, const mini_value* v);
-#endif //_MINI_JSON_H__
+#ifndef _MINI_JSON_H__
+#define _MINI_JSON_H__
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* int64_t, uint64_t */
+#include "../memory/alloc.h"
+
+#ifndef MINI_KEY_INLINE_SIZE
+#define MINI_KEY_INLINE_SIZE 16
+#endif
+
+#define MINI_KEY_NOT_EXIST ((size_t)-1)
+
+/* objects up to this capacity have no hash index and are scanned linearly */
+#ifndef MINI_OBJECT_SCAN_SIZE
+#define MINI_OBJECT_SCAN_SIZE 16
+#endif
+
+/* arrays and objects open at once in a parsed text, beyond it MINI_PARSE_TOO_DEEP */
+#ifndef MINI_PARSE_MAX_DEPTH
+#define MINI_PARSE_MAX_DEPTH 1024
+#endif
+
+typedef enum { MINI_NULL, MINI_FALSE, MINI_TRUE, MINI_NUMBER, MINI_STRING, MINI_ARRAY, MINI_OBJECT } mini_type;
+
+/* integer literals that fit 64 bits are kept exact, UINT64 only above INT64_MAX */
+typedef enum { MINI_NUMBER_DOUBLE, MINI_NUMBER_INT64, MINI_NUMBER_UINT64 } mini_number_kind;
+
+typedef struct {
+    union { double d; int64_t i; uint64_t u; }v;
+    mini_number_kind kind;
+}mini_number;
+
+typedef struct mini_value mini_value;
+typedef struct mini_member mini_member;
+typedef struct mini_document mini_document;
+
+struct mini_value {
+    union {
+        struct { mini_member* m; size_t size, capacity; }o; /* object: members in insertion order, hash index behind large ones */
+        struct { mini_value* e; size_t size, capacity; }a; /* array */
+        struct { char* s; size_t len; }s;  /* string: null-terminated string, string length */
+        mini_number n;                     /* number */
+        struct { const char* json, *end; mini_document* doc; }l; /* lazy document: text of a node not built yet */
+    }u;
+    mini_type type;
+};
+
+struct mini_member {
+    union { char* p; char s[MINI_KEY_INLINE_SIZE]; }k; /* member key: stored inline when klen < MINI_KEY_INLINE_SIZE */
+    size_t klen;                                       /* member key string length */
+    mini_value v;                                      /* member value */
+};
+
+/*
+ * events of mini_parse_sax, in document order. Strings and keys are valid
+ * during the call only and need no terminator. NULL members are skipped,
+ * a nonzero return stops the parse with MINI_PARSE_STOPPED.
+ */
+typedef struct {
+    int (*null_value)(void* user);
+    int (*boolean)(void* user, int b);
+    int (*number)(void* user, const mini_number* n);
+    int (*string)(void* user, const char* s, size_t len);
+    int (*start_object)(void* user);
+    int (*key)(void* user, const char* s, size_t len);
+    int (*end_object)(void* user, size_t members);
+    int (*start_array)(void* user);
+    int (*end_array)(void* user, size_t elements);
+}mini_handler;
+
+/* receives the generated text piece by piece, a nonzero return stops the generator */
+typedef int (*mini_sink)(void* user, const char* data, size_t len);
+
+typedef struct {
+    const char* json, *end;  /* NULL end: the text ends at its '\0' */
+    char* stack;
+    size_t size, top;
+    Arena* arena;  /* NULL: nodes are allocated one by one */
+    const mini_handler* handler;  /* not NULL: events instead of nodes */
+    void* handler_user;
+    mini_sink sink;  /* NULL: the generated text stays on the stack */
+    void* sink_user;
+    int sink_failed;
+    int insitu;  /* strings are decoded into the text, which must be writable */
+    int lazy;    /* values below the container being built keep their text */
+    mini_document* doc;     /* lazy: the document being built */
+    const char** marks;     /* lazy: start and end of each container */
+    size_t nmarks, marks_size;  /* marks_size 0: containers are not recorded */
+    const uint32_t* index;  /* not NULL: whitespace is skipped along this index of text */
+    const char* text;
+    size_t next;            /* first index entry not read yet */
+}mini_context;
+
+/*
+ * a parsed document: every node, string and container of root lives in
+ * arena and is released at once by mini_free_document. The values are
+ * read-only, never pass them to mini_free or the setters, and do not move
+ * the document after parsing.
+ */
+struct mini_document {
+    mini_value root;
+    Arena arena;
+    const char** marks;  /* lazy documents: start and end of every container, in text order */
+    size_t nmarks;
+};
+
+/* one open container of mini_push, kind is '[' or '{' */
+typedef struct {
+    size_t count;
+    int state;
+    char kind;
+}mini_push_level;
+
+/*
+ * incremental parser: the text arrives through mini_push_feed in chunks cut
+ * anywhere, even inside a string or a number. Open containers live on levels
+ * instead of the C stack and a token cut by a chunk boundary waits in buf.
+ * Events go to handler as in mini_parse_sax.
+ */
+typedef struct {
+    mini_context c;
+    mini_push_level* levels;
+    size_t depth, capacity;
+    char* buf;
+    size_t len, cap;
+    int state;  /* of the root value */
+    int token;  /* kind of the token in buf, if any */
+    int escape; /* buf ends inside an escape */
+    int error;  /* the first error is kept */
+}mini_push;
+
+/*
+ * mini_handler that turns the events into a value: root holds it after a
+ * successful parse, open containers and a pending key wait on the stack.
+ */
+typedef struct {
+    mini_value root;
+    mini_value* stack;
+    size_t top, size;
+}mini_builder;
+
+extern const mini_handler mini_builder_handler;
+
+enum {
+    MINI_PARSE_OK = 0,
+    MINI_PARSE_EXPECT_VALUE,
+    MINI_PARSE_INVALID_VALUE,
+    MINI_PARSE_ROOT_NOT_SINGULAR,
+    MINI_PARSE_NUMBER_TOO_BIG,
+    MINI_PARSE_MISS_QUOTATION_MARK,
+    MINI_PARSE_INVALID_STRING_ESCAPE,
+    MINI_PARSE_INVALID_STRING_CHAR,
+    MINI_PARSE_INVALID_UNICODE_HEX,
+    MINI_PARSE_INVALID_UNICODE_SURROGATE,
+    MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET,
+    MINI_PARSE_MISS_KEY,
+    MINI_PARSE_MISS_COLON,
+    MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET,
+    MINI_PARSE_STOPPED,
+    MINI_PARSE_FILE_ERROR,
+    MINI_PARSE_TOO_DEEP,
+    MINI_GENERATE_OK,
+    MINI_GENERATE_SINK_ERROR
+};
+
+/*****************************************
+ *
+ *              interface
+ *
+ *****************************************/
+void mini_show_value(const mini_value* v);
+void mini_add_value_to_array(mini_value* arr, mini_value* v);
+/*
+ * objects keep every member they are given: the add and move functions
+ * append, as the parsers and mini_builder do, an equal key included.
+ * Lookups by key return the first such member.
+ */
+void mini_add_value_to_object(mini_value* obj, mini_value* key, mini_value* value);
+/* take ownership of key/value, the sources are left as MINI_NULL */
+void mini_move_value_to_array(mini_value* arr, mini_value* v);
+void mini_move_value_to_object(mini_value* obj, mini_value* key, mini_value* value);
+
+int mini_parse(mini_value* v, const char* json);
+/* json holds len bytes and may be unterminated, as in a receive buffer or a mapped file */
+int mini_parse_len(mini_value* v, const char* json, size_t len);
+/* validates json and reports it to handler, no node is allocated */
+int mini_parse_sax(const char* json, const mini_handler* handler, void* user);
+/*
+ * two-stage parse: a first pass over all of json indexes its structural
+ * characters, tokens and string ends, the second reads from token to token
+ * without scanning strings. Results and errors match mini_parse_len.
+ */
+int mini_parse_indexed(mini_value* v, const char* json, size_t len);
+int mini_parse_sax_indexed(const char* json, size_t len, const mini_handler* handler, void* user);
+int mini_generate(const mini_value* v, char** json, size_t* length);
+/* streams the text to sink in pieces of about MINI_GENERATE_CHUNK_SIZE bytes */
+int mini_generate_to(const mini_value* v, mini_sink sink, void* user);
+int mini_file_sink(void* fp, const char* data, size_t len); /* user is a FILE* */
+int mini_fd_sink(void* fd, const char* data, size_t len);   /* user points to an int descriptor */
+/* creates or truncates path, MINI_GENERATE_SINK_ERROR if it cannot be written */
+int mini_generate_file(const mini_value* v, const char* path);
+int mini_parse_document(mini_document* doc, const char* json);
+int mini_parse_document_len(mini_document* doc, const char* json, size_t len);
+/*
+ * decodes the strings and long keys over their own text and points at them
+ * there: json is modified and must outlive the document.
+ */
+int mini_parse_document_insitu(mini_document* doc, char* json, size_t len);
+/*
+ * validates json but builds only the root level: a node is built, one level
+ * at a time, when an accessor first returns it. json must outlive the
+ * document, and reads build nodes, so threads need a lock to share one.
+ */
+int mini_parse_lazy(mini_document* doc, const char* json);
+int mini_parse_lazy_len(mini_document* doc, const char* json, size_t len);
+/* the file is mapped read-only for the parse, nothing of it is kept */
+int mini_parse_file(mini_value* v, const char* path);
+int mini_parse_document_file(mini_document* doc, const char* path);
+void mini_free_document(mini_document* doc);
+#define mini_document_root(doc) (&(doc)->root)
+void mini_push_init(mini_push* p, const mini_handler* handler, void* user);
+int mini_push_feed(mini_push* p, const char* data, size_t len);
+/* end of the text: completes a trailing number or literal */
+int mini_push_finish(mini_push* p);
+void mini_push_free(mini_push* p);
+void mini_builder_init(mini_builder* b);
+/* frees the open containers and root, move root out first to keep it */
+void mini_builder_free(mini_builder* b);
+/*
+ * a context keeps its scratch stack from one call to the next: a thread
+ * that parses or generates many texts stops allocating it once it fits
+ * the largest. One thread at a time. The nodes still come from lmalloc,
+ * which has its own per-thread cache.
+ */
+void mini_context_init(mini_context* c);
+void mini_context_free(mini_context* c);
+int mini_context_parse(mini_context* c, mini_value* v, const char* json);
+int mini_context_parse_len(mini_context* c, mini_value* v, const char* json, size_t len);
+int mini_context_parse_sax(mini_context* c, const char* json, const mini_handler* handler, void* user);
+/* json points into c, valid until the next call on it; do not free it */
+int mini_context_generate(mini_context* c, const mini_value* v, const char** json, size_t* length);
+int mini_context_generate_to(mini_context* c, const mini_value* v, mini_sink sink, void* user);
+/* any depth: mini_free and the generators keep the open containers on the heap */
+void mini_free(mini_value* v);
+//for deep copy
+mini_value* mini_backup(mini_value* v);
+void mini_copy(mini_value* dst, const mini_value* src);
+void mini_move(mini_value* dst, mini_value* src);
+
+
+#define mini_init(v) do { (v)->type = MINI_NULL; } while(0)
+
+mini_type mini_get_type(const mini_value* v);
+void mini_set_type(mini_value* v, mini_type type);
+
+#define mini_set_null(v) mini_free(v)
+
+int mini_get_boolean(const mini_value* v);
+void mini_set_boolean(mini_value* v, int b);
+
+double mini_get_number(const mini_value* v); /* any kind, as the nearest double */
+void mini_set_number(mini_value* v, double n);   /* NaN and infinities are generated as null */
+mini_number_kind mini_get_number_kind(const mini_value* v);
+int64_t mini_get_int64(const mini_value* v);   /* INT64 kind, or a UINT64 up to INT64_MAX */
+void mini_set_int64(mini_value* v, int64_t i);
+uint64_t mini_get_uint64(const mini_value* v); /* UINT64 kind, or a non-negative INT64 */
+void mini_set_uint64(mini_value* v, uint64_t u);
+
+const char* mini_get_string(const mini_value* v);
+size_t mini_get_string_length(const mini_value* v);
+void mini_set_string(mini_value* v, const char* s, size_t len);
+
+void mini_init_array(mini_value* v);
+size_t mini_get_array_size(const mini_value* v);
+mini_value* mini_get_array_element(const mini_value* v, size_t index);
+size_t mini_get_array_capacity(const mini_value* v);
+void mini_reserve_array(mini_value* v, size_t capacity);
+void mini_shrink_array(mini_value* v);
+
+void mini_init_object(mini_value* v);
+size_t mini_get_object_size(const mini_value* v);
+mini_value* mini_get_object_value(const mini_value* v, const char* key); /* NULL if key does not exist */
+/* key needs no terminator and may hold '\0', the first matching member wins */
+size_t mini_find_object_index(const mini_value* v, const char* key, size_t klen); /* MINI_KEY_NOT_EXIST if key does not exist */
+mini_value* mini_find_object_value(const mini_value* v, const char* key, size_t klen);
+const char* mini_get_object_key(const mini_value* v, size_t index);
+size_t mini_get_object_key_length(const mini_value* v, size_t index);
+mini_value* mini_get_object_value_at(const mini_value* v, size_t index);
+size_t mini_get_object_capacity(const mini_value* v);
+void mini_reserve_object(mini_value* v, size_t capacity);
+
+#endif //_MINI_JSON_H__
@@ -0,0 +1,19 @@
+#ifndef _MINI_NUMBER_H__
+#define _MINI_NUMBER_H__
+
+#include "mini_json.h"
+
+/*
+ * reads one json number at p. Integer literals that fit 64 bits are kept
+ * exact, everything else (and "-0") becomes the nearest double, ties to
+ * even. returns the end of the number, or NULL if p does not hold the
+ * number grammar. Values too large for a double come back as +-HUGE_VAL.
+ */
+const char* mini_read_number(const char* p, mini_number* n);
+/* decimal digits of u, no terminator; returns the count, at most 20 */
+size_t mini_write_uint64(char* buf, uint64_t u);
+size_t mini_write_int64(char* buf, int64_t i);
+/* shortest digits that read back as d, laid out like "%.17g"; finite d, at most 25 bytes */
+size_t mini_write_double(char* buf, double d);
+
+#endif
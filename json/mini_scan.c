@@ -0,0 +1,167 @@
+#include "mini_scan.h"
+#include <stddef.h>  /* NULL */
+#include <stdint.h>  /* uintptr_t */
+
+#define ISWHITESPACE(ch)    ((ch) == ' ' || (ch) == '\t' || (ch) == '\n' || (ch) == '\r')
+#define ISSTRINGSTOP(ch)    ((ch) == '\"' || (ch) == '\\' || (unsigned char)(ch) < 0x20)
+
+static const char* mini_skip_whitespace_scalar(const char* p, const char* end) {
+    while (p != end && ISWHITESPACE(*p))
+        p++;
+    return p;
+}
+
+static const char* mini_scan_string_scalar(const char* p, const char* end) {
+    while (p != end && !ISSTRINGSTOP(*p))
+        p++;
+    return p;
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+
+/*
+ * the kernels load whole aligned blocks: a block never crosses a page, but
+ * it may hold bytes before p or from end on, which the masks drop and the
+ * address and thread sanitizers would report. valgrind has no such switch,
+ * its memcheck needs --partial-loads-ok=yes. p < end, so the first block
+ * is in bounds.
+ */
+#define MINI_SIMD(isa) __attribute__((target(isa), no_sanitize("address", "thread")))
+#define MINI_BOUND(p, end) ((end) != NULL && (end) < (p) ? (end) : (p))
+
+MINI_SIMD("sse2")
+static unsigned int mini_whitespace_mask_sse2(__m128i x) {
+    __m128i ws = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(x, _mm_set1_epi8('\t'))),
+        _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(x, _mm_set1_epi8('\r'))));
+    return ~(unsigned int)_mm_movemask_epi8(ws) & 0xFFFFu;
+}
+
+MINI_SIMD("sse2")
+static unsigned int mini_string_mask_sse2(__m128i x) {
+    /* x <= 0x1F as unsigned bytes: max(x, 0x1F) == 0x1F */
+    __m128i ctrl = _mm_set1_epi8(0x1F);
+    __m128i stop = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\"')), _mm_cmpeq_epi8(x, _mm_set1_epi8('\\'))),
+        _mm_cmpeq_epi8(_mm_max_epu8(x, ctrl), ctrl));
+    return (unsigned int)_mm_movemask_epi8(stop);
+}
+
+MINI_SIMD("sse2")
+static const char* mini_skip_whitespace_sse2(const char* p, const char* end) {
+    const char* base = (const char*)((uintptr_t)p & ~(uintptr_t)15);
+    unsigned int mask = mini_whitespace_mask_sse2(_mm_load_si128((const __m128i*)base)) >> (p - base);
+    if (mask != 0)
+        return MINI_BOUND(p + __builtin_ctz(mask), end);
+    for (;;) {
+        base += 16;
+        if (end != NULL && base >= end)
+            return end;
+        mask = mini_whitespace_mask_sse2(_mm_load_si128((const __m128i*)base));
+        if (mask != 0)
+            return MINI_BOUND(base + __builtin_ctz(mask), end);
+    }
+}
+
+MINI_SIMD("sse2")
+static const char* mini_scan_string_sse2(const char* p, const char* end) {
+    const char* base = (const char*)((uintptr_t)p & ~(uintptr_t)15);
+    unsigned int mask = mini_string_mask_sse2(_mm_load_si128((const __m128i*)base)) >> (p - base);
+    if (mask != 0)
+        return MINI_BOUND(p + __builtin_ctz(mask), end);
+    for (;;) {
+        base += 16;
+        if (end != NULL && base >= end)
+            return end;
+        mask = mini_string_mask_sse2(_mm_load_si128((const __m128i*)base));
+        if (mask != 0)
+            return MINI_BOUND(base + __builtin_ctz(mask), end);
+    }
+}
+
+MINI_SIMD("avx2")
+static unsigned int mini_whitespace_mask_avx2(__m256i x) {
+    __m256i ws = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\t'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\r'))));
+    return ~(unsigned int)_mm256_movemask_epi8(ws);
+}
+
+MINI_SIMD("avx2")
+static unsigned int mini_string_mask_avx2(__m256i x) {
+    __m256i ctrl = _mm256_set1_epi8(0x1F);
+    __m256i stop = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\"')), _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\\'))),
+        _mm256_cmpeq_epi8(_mm256_max_epu8(x, ctrl), ctrl));
+    return (unsigned int)_mm256_movemask_epi8(stop);
+}
+
+MINI_SIMD("avx2")
+static const char* mini_skip_whitespace_avx2(const char* p, const char* end) {
+    const char* base = (const char*)((uintptr_t)p & ~(uintptr_t)31);
+    unsigned int mask = mini_whitespace_mask_avx2(_mm256_load_si256((const __m256i*)base)) >> (p - base);
+    if (mask != 0)
+        return MINI_BOUND(p + __builtin_ctz(mask), end);
+    for (;;) {
+        base += 32;
+        if (end != NULL && base >= end)
+            return end;
+        mask = mini_whitespace_mask_avx2(_mm256_load_si256((const __m256i*)base));
+        if (mask != 0)
+            return MINI_BOUND(base + __builtin_ctz(mask), end);
+    }
+}
+
+MINI_SIMD("avx2")
+static const char* mini_scan_string_avx2(const char* p, const char* end) {
+    const char* base = (const char*)((uintptr_t)p & ~(uintptr_t)31);
+    unsigned int mask = mini_string_mask_avx2(_mm256_load_si256((const __m256i*)base)) >> (p - base);
+    if (mask != 0)
+        return MINI_BOUND(p + __builtin_ctz(mask), end);
+    for (;;) {
+        base += 32;
+        if (end != NULL && base >= end)
+            return end;
+        mask = mini_string_mask_avx2(_mm256_load_si256((const __m256i*)base));
+        if (mask != 0)
+            return MINI_BOUND(base + __builtin_ctz(mask), end);
+    }
+}
+
+static const char* (*mini_skip_whitespace_impl)(const char*, const char*) = mini_skip_whitespace_scalar;
+static const char* (*mini_scan_string_impl)(const char*, const char*) = mini_scan_string_scalar;
+
+/* picked once at load time, before any thread can parse */
+__attribute__((constructor))
+static void mini_scan_init(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        mini_skip_whitespace_impl = mini_skip_whitespace_avx2;
+        mini_scan_string_impl = mini_scan_string_avx2;
+    }
+    else if (__builtin_cpu_supports("sse2")) {
+        mini_skip_whitespace_impl = mini_skip_whitespace_sse2;
+        mini_scan_string_impl = mini_scan_string_sse2;
+    }
+}
+
+#else
+
+#define mini_skip_whitespace_impl mini_skip_whitespace_scalar
+#define mini_scan_string_impl mini_scan_string_scalar
+
+#endif
+
+/* most runs are a single space or none at all, only longer ones go wide */
+const char* mini_skip_whitespace(const char* p, const char* end) {
+    if (p == end || !ISWHITESPACE(*p))
+        return p;
+    if (++p == end || !ISWHITESPACE(*p))
+        return p;
+    return ++p == end ? p : mini_skip_whitespace_impl(p, end);
+}
+
+const char* mini_scan_string(const char* p, const char* end) {
+    return p == end ? p : mini_scan_string_impl(p, end);
+}
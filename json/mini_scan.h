@@ -0,0 +1,15 @@
+#ifndef _MINI_SCAN_H__
+#define _MINI_SCAN_H__
+
+/*
+ * byte scanners of the parser. Both return end when nothing is found before
+ * it, and never look past the aligned block that holds end - 1. A NULL end
+ * stands for the '\0' terminator, where both stop anyway.
+ */
+
+/* first byte in [p, end) that is not ' ', '\t', '\n' or '\r' */
+const char* mini_skip_whitespace(const char* p, const char* end);
+/* first byte in [p, end) that is '"', '\\' or a control character (< 0x20) */
+const char* mini_scan_string(const char* p, const char* end);
+
+#endif
@@ -1,146 +1,499 @@
 #include "alloc.h"
+#ifdef __GLIBC__
+#include <malloc.h>  /* malloc_trim() */
+#endif
 
-// main manage var
-Heap heap = {NULL, NULL, 0};
-chunk *chunk_list[16] = {NULL};
-int Min_size = 8;
-int Max_size = 128;
+// main manage var, heap and chunk_list are guarded by central_lock
+Heap heap = {NULL, NULL, 0, NULL, NULL};
+chunk *chunk_list[NCLASS] = {NULL};
+size_t central_count[NCLASS] = {0};
+pthread_mutex_t central_lock = PTHREAD_MUTEX_INITIALIZER;
+// live thread caches for lalloc_stats, and what exited threads left behind
+thread_cache *cache_registry = NULL;
+long retired_in_use = 0;
+long retired_large_in_use = 0;
+static _Thread_local thread_cache tcache;
+static pthread_key_t tcache_key;
+static pthread_once_t tcache_once = PTHREAD_ONCE_INIT;
+size_t Class_size[NCLASS] = {
+	16, 32, 48, 64, 80, 96, 112, 128, 144, 160, 176, 192, 208, 224, 240, 256,
+	320, 384, 448, 512, 640, 768, 896, 1024,
+	1280, 1536, 1792, 2048, 2560, 3072, 3584, 4096
+};
+size_t Min_size = 16;
+size_t Max_size = 4096;
 int Nnum = 20;
+size_t Batch_bytes = 8192;
+size_t Arena_block_size = 4096;
 
-void *lalloc(int size, int n){
+static thread_cache *get_thread_cache();
+static void thread_cache_exit(void *);
+
+// only the owner writes, so a plain relaxed load and store is enough
+static void counter_add(_Atomic long *p, long n) {
+	atomic_store_explicit(p, atomic_load_explicit(p, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static void count_add(_Atomic int *p, int n) {
+	atomic_store_explicit(p, atomic_load_explicit(p, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static void large_used_add(long n) {
+	thread_cache *tc = get_thread_cache();
+	counter_add(&tc->in_use, n);
+	counter_add(&tc->large_in_use, n);
+}
+
+static void *block_alloc(size_t need) {
+	size_t alloc_size = need + sizeof(block_header);
+	block_header *res;
+	if (alloc_size > Max_size) {
+		res = (block_header *)malloc(alloc_size);
+		if (res == NULL) {
+			return NULL;
+		}
+		res->cls = NCLASS;
+		large_used_add((long)alloc_size);
+	}
+	else {
+		int indx = Index(alloc_size);
+		res = (block_header *)chunk_alloc(Class_size[indx]);
+		if (res == NULL) {
+			return NULL;
+		}
+		res->cls = indx;
+	}
+	res->size = need;
+	return res + 1;
+}
+
+void *lalloc(size_t size, size_t n){
 	// behavior is like calloc
 	assert (size > 0 && n > 0);
-	// for contain the size
-	int alloc_size = size*n + 2;
-	if (alloc_size > Max_size) {
-		void *p = calloc(size, n);
-		(*(char *)p) = alloc_size;
-		return ((char *)p) + 2;
+	void *res = block_alloc(size*n);
+	if (res != NULL) {
+		memset(res, 0, size*n);
 	}
-	void *res = chunk_alloc(alloc_size);
-	//最开始的2个字节存储size大小
-	*((char *)res) = alloc_size;
-	return ((char *)res) + 2;
+	return res;
+}
+
+void *lmalloc(size_t size) {
+	assert (size > 0);
+	return block_alloc(size);
+}
+
+void *lrealloc(void *p, size_t size) {
+	if (p == NULL) {
+		return lmalloc(size);
+	}
+	block_header *head = (block_header *)p - 1;
+	if (head->cls == NCLASS && size + sizeof(block_header) > Max_size) {
+		size_t old_size = head->size;
+		head = (block_header *)realloc(head, size + sizeof(block_header));
+		if (head == NULL) {
+			return NULL;
+		}
+		head->size = size;
+		large_used_add((long)size - (long)old_size);
+		return head + 1;
+	}
+	if (head->cls < NCLASS && size + sizeof(block_header) <= Class_size[head->cls]) {
+		// still fits in its chunk
+		head->size = size;
+		return p;
+	}
+	void *res = lmalloc(size);
+	if (res != NULL) {
+		memcpy(res, p, head->size < size ? head->size : size);
+		lfree(p);
+	}
+	return res;
 }
 
 void lfree(void *p) {
-	p = (short *)p - 1;
-	short size= *(short *)p;
-	if (size > Max_size) {
-		free(p);
+	if (p == NULL) {
+		return;
+	}
+	block_header *head = (block_header *)p - 1;
+	if (head->cls == NCLASS) {
+		large_used_add(-(long)(head->size + sizeof(block_header)));
+		free(head);
 	}
 	else {
-		int indx = Index(round_up(size));
-		// head insert the p
-		chunk *next = chunk_list[indx];
-		chunk_list[indx] = (chunk *)p;
-		chunk_list[indx]->next_chunk = next;
+		chunk_free(head, (int)head->cls);
 	}
 }
 
 
-int round_up(int size) {
-	return (size+Min_size-1) & ~(Min_size-1);
+size_t round_up(size_t size) {
+	return Class_size[Index(size)];
 }
 
-int Index(int size) {
-	assert(size%8 == 0);
-	return (size >> 3) - 1;
+int Index(size_t size) {
+	assert(size > 0 && size <= Max_size);
+	if (size <= 256) return (int)((size - 1) >> 4);
+	if (size <= 512) return 16 + (int)((size - 257) >> 6);
+	if (size <= 1024) return 20 + (int)((size - 513) >> 7);
+	if (size <= 2048) return 24 + (int)((size - 1025) >> 8);
+	return 28 + (int)((size - 2049) >> 9);
+}
+
+int batch_num(int indx) {
+	// big classes move fewer chunks at a time
+	int num = (int)(Batch_bytes / Class_size[indx]);
+	if (num > Nnum) num = Nnum;
+	if (num < 2) num = 2;
+	return num;
+}
+
+static void tcache_key_init() {
+	pthread_key_create(&tcache_key, thread_cache_exit);
+}
+
+static thread_cache *get_thread_cache() {
+	thread_cache *tc = &tcache;
+	if (!tc->registered) {
+		// the key destructor hands the cache back when the thread exits
+		pthread_once(&tcache_once, tcache_key_init);
+		pthread_setspecific(tcache_key, tc);
+		tc->registered = true;
+		pthread_mutex_lock(&central_lock);
+		tc->prev_cache = NULL;
+		tc->next_cache = cache_registry;
+		if (cache_registry != NULL) cache_registry->prev_cache = tc;
+		cache_registry = tc;
+		pthread_mutex_unlock(&central_lock);
+	}
+	return tc;
 }
 
 void *chunk_alloc(int size) {
-	size = round_up(size);
 	int indx = Index(size);
-	if (chunk_list[indx] != NULL) {
-		chunk* res = chunk_list[indx];
-		chunk_list[indx] = res->next_chunk;
-		memset(res, 0, size);
-		return res;
+	thread_cache *tc = get_thread_cache();
+	if (tc->list[indx] == NULL && !central_fetch(tc, indx)) {
+		return NULL;
 	}
-	if (heap_refill(indx)) {
-		//refill from heap successfully
-		return chunk_alloc(size);
+	chunk* res = tc->list[indx];
+	tc->list[indx] = res->next_chunk;
+	count_add(&tc->count[indx], -1);
+	counter_add(&tc->in_use, (long)Class_size[indx]);
+	return res;
+}
+
+void chunk_free(void *p, int indx) {
+	thread_cache *tc = get_thread_cache();
+	// head insert the p
+	((chunk *)p)->next_chunk = tc->list[indx];
+	tc->list[indx] = (chunk *)p;
+	count_add(&tc->count[indx], 1);
+	counter_add(&tc->in_use, -(long)Class_size[indx]);
+	if (tc->count[indx] >= 2*batch_num(indx)) {
+		central_release(tc, indx, batch_num(indx));
 	}
-	else {
-		return NULL;
+}
+
+bool central_fetch(thread_cache *tc, int indx) {
+	pthread_mutex_lock(&central_lock);
+	if (chunk_list[indx] == NULL && !heap_refill(indx)) {
+		pthread_mutex_unlock(&central_lock);
+		return false;
+	}
+	// cut at most one batch from the head of chunk_list
+	chunk *first = chunk_list[indx];
+	chunk *last = first;
+	int num = 1;
+	int batch = batch_num(indx);
+	for (; num < batch && last->next_chunk != NULL; ++num) {
+		last = last->next_chunk;
+	}
+	chunk_list[indx] = last->next_chunk;
+	central_count[indx] -= num;
+	pthread_mutex_unlock(&central_lock);
+	last->next_chunk = tc->list[indx];
+	tc->list[indx] = first;
+	count_add(&tc->count[indx], num);
+	return true;
+}
+
+void central_release(thread_cache *tc, int indx, int num) {
+	chunk *first = tc->list[indx];
+	if (first == NULL || num <= 0) {
+		return;
+	}
+	chunk *last = first;
+	int i = 1;
+	for (; i < num && last->next_chunk != NULL; ++i) {
+		last = last->next_chunk;
+	}
+	tc->list[indx] = last->next_chunk;
+	count_add(&tc->count[indx], -i);
+	pthread_mutex_lock(&central_lock);
+	last->next_chunk = chunk_list[indx];
+	chunk_list[indx] = first;
+	central_count[indx] += i;
+	pthread_mutex_unlock(&central_lock);
+}
+
+static void thread_cache_exit(void *p) {
+	thread_cache *tc = (thread_cache *)p;
+	thread_cache_flush(tc);
+	pthread_mutex_lock(&central_lock);
+	retired_in_use += tc->in_use;
+	retired_large_in_use += tc->large_in_use;
+	tc->in_use = 0;
+	tc->large_in_use = 0;
+	if (tc->prev_cache != NULL) tc->prev_cache->next_cache = tc->next_cache;
+	else cache_registry = tc->next_cache;
+	if (tc->next_cache != NULL) tc->next_cache->prev_cache = tc->prev_cache;
+	pthread_mutex_unlock(&central_lock);
+	// a later lfree in another destructor registers the cache again
+	tc->registered = false;
+}
+
+void thread_cache_flush(void *p) {
+	thread_cache *tc = (thread_cache *)p;
+	int i = 0;
+	for (; i < NCLASS; ++i) {
+		central_release(tc, i, tc->count[i]);
 	}
 }
 
+// the biggest class that fits in size, -1 if none
+static int floor_index(size_t size) {
+	int i = NCLASS - 1;
+	while (i >= 0 && Class_size[i] > size) --i;
+	return i;
+}
 
 bool heap_refill(int index) {
-	int left_size = heap.end - heap.start;
-	int size = Min_size * (index + 1);
-	int need_size = size*Nnum;
-	int num = Nnum;
+	size_t left_size = heap.end - heap.start;
+	size_t size = Class_size[index];
+	int num = batch_num(index);
+	size_t need_size = size*num;
 	// mem: to be link into chunk_list
 	// heap.start: next tobe used memory
 	char *mem = NULL;
-	//not enough for Nnums
+	//not enough for a batch
 	if (left_size < need_size) {
 		// enough for one
-		if (left_size > size) {
+		if (left_size >= size) {
 			num = left_size/size;
 			mem = heap.start;
 			heap.start += num*size;
+			if (heap.current != NULL) heap.current->used += num*size;
 		}
 		else {
 			// not enough for one so use malloc for new and deal left
-			if (left_size > 0) {
-				int indx = Index(left_size);
-				// head insert into chunk_list
+			int indx = floor_index(left_size);
+			if (indx >= 0) {
+				// head insert into chunk_list, the tail under 16 bytes is dropped
 				chunk *next = chunk_list[indx];
 				chunk_list[indx] = (chunk*)heap.start;
 				chunk_list[indx]->next_chunk = next;
+				central_count[indx]++;
+				if (heap.current != NULL) heap.current->used += Class_size[indx];
 			}
-			int get_size = 2*need_size + round_up(heap.total_size>>1);
-			// start += left_size;
-			heap.start = (char *)malloc(get_size);
-			if (heap.start == NULL) {
-				// malloc failed, so get some from behind
-				int i = Index(size) + 1;
-				// start + add_sz == end
-				int add_sz = size + Min_size;
+			size_t get_size = 2*need_size + ((heap.total_size>>1) & ~(Min_size-1));
+			heap_block *block = (heap_block *)malloc(sizeof(heap_block) + get_size);
+			heap.start = NULL;
+			if (block == NULL) {
+				// malloc failed, so cut a chunk of a bigger class
+				int i = index + 1;
 				bool flg = false;
-				for (; i<16; ++i, add_sz+=Min_size) {
+				for (; i<NCLASS; ++i) {
 					if (chunk_list[i] != NULL) {
-						num = add_sz/size;
+						num = Class_size[i]/size;
 						mem = (char *)chunk_list[i];
 						heap.start = mem + num*size;
-						heap.end = mem + add_sz;
+						heap.end = mem + Class_size[i];
 						///////////////////////////
 						chunk_list[i] = chunk_list[i]->next_chunk;
+						central_count[i]--;
+						// already counted as used by its own block
+						heap.current = NULL;
 						flg = true;
 						break;
 					}
 				}
 				if (!flg) {
+					heap.end = NULL;
 					return false;
 				}
 			}
 			else {
-				mem = heap.start;
-				heap.start += num*size;
+				block->size = sizeof(heap_block) + get_size;
+				block->used = num*size;
+				block->next = heap.blocks;
+				heap.blocks = block;
+				heap.current = block;
+				mem = (char *)(block + 1);
+				heap.start = mem + num*size;
 				heap.end = mem + get_size;
-				heap.total_size += get_size;
+				heap.total_size += block->size;
 			}
 		}
 	}
 	else {
 		mem = heap.start;
 		heap.start += need_size;
+		if (heap.current != NULL) heap.current->used += need_size;
 	}
+	central_count[index] += num;
 	// link for chunk_list
 	chunk *current = (chunk *)mem;
 	chunk *next = (chunk *)((char *)current + size);
 	chunk_list[index] = current;
 	//1->2 2->3 3->4 19->20 next(20)->NULL
 	int i = 0;
-    for (; i<num-1; ++i) {
+	for (; i<num-1; ++i) {
 		current->next_chunk = next;
 
 		current = next;
 		next = (chunk *)((char *)next + size);
-	}	
-	next->next_chunk = NULL;
+	}
+	current->next_chunk = NULL;
 	return true;
 }
+
+static int block_address_cmp(const void *a, const void *b) {
+	const heap_block *x = *(const heap_block **)a;
+	const heap_block *y = *(const heap_block **)b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// the block holding p, blocks is sorted by address
+static heap_block *find_block(heap_block **blocks, size_t n, void *p) {
+	size_t lo = 0, hi = n;
+	while (lo < hi) {
+		size_t mid = (lo + hi) >> 1;
+		if ((char *)blocks[mid] > (char *)p) hi = mid;
+		else if ((char *)blocks[mid] + blocks[mid]->size <= (char *)p) lo = mid + 1;
+		else return blocks[mid];
+	}
+	return NULL;
+}
+
+size_t lalloc_trim() {
+	size_t released = 0, n = 0, i;
+	heap_block *block, **blocks, **pp;
+	thread_cache_flush(get_thread_cache());
+	pthread_mutex_lock(&central_lock);
+	for (block = heap.blocks; block != NULL; block = block->next) ++n;
+	blocks = (heap_block **)malloc(n * sizeof(heap_block *) + 1);
+	if (blocks == NULL) {
+		pthread_mutex_unlock(&central_lock);
+		return 0;
+	}
+	for (i = 0, block = heap.blocks; block != NULL; block = block->next) {
+		block->free_size = 0;
+		blocks[i++] = block;
+	}
+	qsort(blocks, n, sizeof(heap_block *), block_address_cmp);
+	// a block can go once every chunk cut from it is back on chunk_list
+	int indx = 0;
+	for (; indx < NCLASS; ++indx) {
+		chunk *p = chunk_list[indx];
+		for (; p != NULL; p = p->next_chunk) {
+			block = find_block(blocks, n, p);
+			if (block != NULL) block->free_size += Class_size[indx];
+		}
+	}
+	for (i = 0; i < n; ++i) {
+		// mark the victims with free_size == 0 and used == SIZE_MAX
+		if (blocks[i] != heap.current && blocks[i]->free_size == blocks[i]->used) {
+			blocks[i]->used = (size_t)-1;
+		}
+	}
+	for (indx = 0; indx < NCLASS; ++indx) {
+		chunk **link = &chunk_list[indx];
+		while (*link != NULL) {
+			block = find_block(blocks, n, *link);
+			if (block != NULL && block->used == (size_t)-1) {
+				*link = (*link)->next_chunk;
+				central_count[indx]--;
+			}
+			else {
+				link = &(*link)->next_chunk;
+			}
+		}
+	}
+	for (pp = &heap.blocks; *pp != NULL; ) {
+		block = *pp;
+		if (block->used == (size_t)-1) {
+			*pp = block->next;
+			released += block->size;
+			heap.total_size -= block->size;
+			free(block);
+		}
+		else {
+			pp = &block->next;
+		}
+	}
+	pthread_mutex_unlock(&central_lock);
+	free(blocks);
+#ifdef __GLIBC__
+	malloc_trim(0);
+#endif
+	return released;
+}
+
+void lalloc_stats(AllocStats *stats) {
+	long in_use, large_in_use;
+	thread_cache *tc;
+	int i;
+	pthread_mutex_lock(&central_lock);
+	in_use = retired_in_use;
+	large_in_use = retired_large_in_use;
+	for (i = 0; i < NCLASS; ++i) {
+		stats->free_chunks[i] = central_count[i];
+	}
+	for (tc = cache_registry; tc != NULL; tc = tc->next_cache) {
+		in_use += atomic_load_explicit(&tc->in_use, memory_order_relaxed);
+		large_in_use += atomic_load_explicit(&tc->large_in_use, memory_order_relaxed);
+		for (i = 0; i < NCLASS; ++i) {
+			stats->free_chunks[i] += atomic_load_explicit(&tc->count[i], memory_order_relaxed);
+		}
+	}
+	stats->reserved = heap.total_size + (large_in_use > 0 ? (size_t)large_in_use : 0);
+	stats->in_use = in_use > 0 ? (size_t)in_use : 0;
+	pthread_mutex_unlock(&central_lock);
+}
+
+void arena_init(Arena *arena) {
+	arena->blocks = NULL;
+	arena->start = arena->end = NULL;
+	arena->total_size = 0;
+}
+
+void *arena_alloc(Arena *arena, size_t size) {
+	size = (size + 15) & ~(size_t)15;
+	if ((size_t)(arena->end - arena->start) < size) {
+		// new block grows with the arena like heap_refill does
+		size_t get_size = Arena_block_size + (arena->total_size >> 1);
+		if (get_size < size + sizeof(arena_block))
+			get_size = size + sizeof(arena_block);
+		arena_block *block = (arena_block *)malloc(get_size);
+		if (block == NULL) {
+			return NULL;
+		}
+		block->next = arena->blocks;
+		block->size = get_size;
+		arena->blocks = block;
+		arena->total_size += get_size;
+		arena->start = (char *)(block + 1);
+		arena->end = (char *)block + get_size;
+	}
+	void *res = arena->start;
+	arena->start += size;
+	return res;
+}
+
+void arena_clear(Arena *arena) {
+	arena_block *block = arena->blocks;
+	while (block != NULL) {
+		arena_block *next = block->next;
+		free(block);
+		block = next;
+	}
+	arena_init(arena);
+}
@@ -5,35 +5,115 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 /*
  * 这里不实现一级空间配置器, 需要的地方直接使用malloc
  */
 
+// every block the heap gets from malloc starts with it
+typedef struct heap_block{
+	struct heap_block *next;
+	size_t size;       // the whole block, header included
+	size_t used;       // bytes already cut into chunks
+	size_t free_size;  // scratch for lalloc_trim
+}heap_block;
+
 // all memory managements
 typedef struct Heap{
 	char *start;
 	char *end;
-	int total_size;
+	size_t total_size;
+	heap_block *blocks;
+	heap_block *current;  // owner of [start, end), NULL if it is a borrowed chunk
 }Heap;
 
-// 8 16 24 32 n*8->128
+// size classes (header included), all multiples of 16:
+// 16..256 step 16, ..512 step 64, ..1024 step 128, ..2048 step 256, ..4096 step 512
+#define NCLASS 32
 typedef struct chunk{
 	struct chunk *next_chunk;
 }chunk;
 
+// every block starts with it, the user pointer follows it so that
+// 16 bytes alignment is kept; cls == NCLASS means a block from malloc
+typedef struct block_header{
+	size_t size;
+	size_t cls;
+}block_header;
+
+// every thread keeps its own chunk lists, so the fast path takes no lock.
+// chunks move between a thread cache and the shared chunk_list in batches
+// under central_lock; a chunk freed by another thread simply joins that
+// thread's cache.
+// the counters are written by the owner only, lalloc_stats reads them
+typedef struct thread_cache{
+	chunk *list[NCLASS];
+	_Atomic int count[NCLASS];
+	_Atomic long in_use;        // pooled and large bytes, may go negative
+	_Atomic long large_in_use;  // after frees of other threads' blocks
+	bool registered;
+	struct thread_cache *prev_cache;
+	struct thread_cache *next_cache;
+}thread_cache;
+
+typedef struct AllocStats{
+	size_t reserved;             // heap blocks and large blocks from malloc
+	size_t in_use;               // chunks and large blocks handed out
+	size_t free_chunks[NCLASS];  // on chunk_list and in all thread caches
+}AllocStats;
+
+
 
+// region allocator: memory is carved from a few big blocks and
+// released all at once, there is no per-allocation free
+typedef struct arena_block{
+	struct arena_block *next;
+	size_t size;
+}arena_block;
+
+typedef struct Arena{
+	arena_block *blocks;
+	char *start;
+	char *end;
+	size_t total_size;
+}Arena;
 
 // main function
-// more 1 bytes for content the full size of mem
-void *lalloc(int, int);
+// a block_header in front of every block records its size
+void *lalloc(size_t, size_t);
+// like malloc: the memory is not zeroed
+void *lmalloc(size_t);
+// p may be NULL, the content is kept up to the smaller size
+void *lrealloc(void *, size_t);
 void lfree(void *);
 //alloc from chunk_list vs malloc
 void *chunk_alloc(int);
-// change size to n*8
-int round_up(int);
-// give a n*8 get n
-int Index(int);
+// give a chunk of class indx back to the thread cache
+void chunk_free(void *, int);
+// round size up to its class size
+size_t round_up(size_t);
+// class index of a chunk size, size <= Max_size
+int Index(size_t);
+// chunks moved per batch for class indx
+int batch_num(int);
 // refill mem for indx, if success return pointer, nor NULL
+// the caller holds central_lock
 bool heap_refill(int);
+// move a batch between a thread cache and chunk_list
+bool central_fetch(thread_cache *, int);
+void central_release(thread_cache *, int, int);
+// return every cached chunk of the calling thread to chunk_list
+void thread_cache_flush(void *);
+// give heap blocks with no chunk in use back to the system, chunks cached
+// by other threads still pin their blocks; return the bytes released
+size_t lalloc_trim();
+void lalloc_stats(AllocStats *);
+
+void arena_init(Arena *);
+// 16 bytes aligned, NOT zeroed
+void *arena_alloc(Arena *, size_t);
+// give every block back, the arena can be reused afterwards
+void arena_clear(Arena *);
 #endif
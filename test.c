@@ -1,528 +1,1763 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include "./json/mini_json.h"
-
-static int main_ret = 0;
-static int test_count = 0;
-static int test_pass = 0;
-
-#define EXPECT_EQ_BASE(equality, expect, actual, format) \
-    do {\
-        test_count++;\
-        if (equality)\
-            test_pass++;\
-        else {\
-            fprintf(stderr, "%s:%d: expect: " format " actual: " format "\n", __FILE__, __LINE__, expect, actual);\
-            main_ret = 1;\
-        }\
-    } while(0)
-
-#define EXPECT_EQ_INT(expect, actual) EXPECT_EQ_BASE((expect) == (actual), expect, actual, "%d")
-#define EXPECT_EQ_DOUBLE(expect, actual) EXPECT_EQ_BASE((expect) == (actual), expect, actual, "%.17g")
-#define EXPECT_EQ_STRING(expect, actual, alength) \
-    EXPECT_EQ_BASE(sizeof(expect) - 1 == alength && memcmp(expect, actual, alength) == 0, expect, actual, "%s")
-#define EXPECT_TRUE(actual) EXPECT_EQ_BASE((actual) != 0, "true", "false", "%s")
-#define EXPECT_FALSE(actual) EXPECT_EQ_BASE((actual) == 0, "false", "true", "%s")
-#define EXPECT_EQ_SIZE_T(expect, actual) EXPECT_EQ_BASE((expect) == (actual), (size_t)expect, (size_t)actual, "%zu")
-
-
-static void test_parse_null() {
-    mini_value v;
-    mini_init(&v);
-    mini_set_boolean(&v, 0);
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "null"));
-    EXPECT_EQ_INT(MINI_NULL, mini_get_type(&v));
-    mini_free(&v);
-}
-
-static void test_parse_true() {
-    mini_value v;
-    mini_init(&v);
-    mini_set_boolean(&v, 0);
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "true"));
-    EXPECT_EQ_INT(MINI_TRUE, mini_get_type(&v));
-    mini_free(&v);
-}
-
-static void test_parse_false() {
-    mini_value v;
-    mini_init(&v);
-    mini_set_boolean(&v, 1);
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "false"));
-    EXPECT_EQ_INT(MINI_FALSE, mini_get_type(&v));
-    mini_free(&v);
-}
-
-#define TEST_NUMBER(expect, json)\
-    do {\
-        mini_value v;\
-        mini_init(&v);\
-        EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, json));\
-        EXPECT_EQ_INT(MINI_NUMBER, mini_get_type(&v));\
-        EXPECT_EQ_DOUBLE(expect, mini_get_number(&v));\
-        mini_free(&v);\
-    } while(0)
-
-static void test_parse_number() {
-    TEST_NUMBER(0.0, "0");
-    TEST_NUMBER(0.0, "-0");
-    TEST_NUMBER(0.0, "-0.0");
-    TEST_NUMBER(1.0, "1");
-    TEST_NUMBER(-1.0, "-1");
-    TEST_NUMBER(1.5, "1.5");
-    TEST_NUMBER(-1.5, "-1.5");
-    TEST_NUMBER(3.1416, "3.1416");
-    TEST_NUMBER(1E10, "1E10");
-    TEST_NUMBER(1e10, "1e10");
-    TEST_NUMBER(1E+10, "1E+10");
-    TEST_NUMBER(1E-10, "1E-10");
-    TEST_NUMBER(-1E10, "-1E10");
-    TEST_NUMBER(-1e10, "-1e10");
-    TEST_NUMBER(-1E+10, "-1E+10");
-    TEST_NUMBER(-1E-10, "-1E-10");
-    TEST_NUMBER(1.234E+10, "1.234E+10");
-    TEST_NUMBER(1.234E-10, "1.234E-10");
-    TEST_NUMBER(0.0, "1e-10000"); /* must underflow */
-
-    TEST_NUMBER(1.0000000000000002, "1.0000000000000002"); /* the smallest number > 1 */
-    TEST_NUMBER( 4.9406564584124654e-324, "4.9406564584124654e-324"); /* minimum denormal */
-    TEST_NUMBER(-4.9406564584124654e-324, "-4.9406564584124654e-324");
-    TEST_NUMBER( 2.2250738585072009e-308, "2.2250738585072009e-308");  /* Max subnormal double */
-    TEST_NUMBER(-2.2250738585072009e-308, "-2.2250738585072009e-308");
-    TEST_NUMBER( 2.2250738585072014e-308, "2.2250738585072014e-308");  /* Min normal positive double */
-    TEST_NUMBER(-2.2250738585072014e-308, "-2.2250738585072014e-308");
-    TEST_NUMBER( 1.7976931348623157e+308, "1.7976931348623157e+308");  /* Max double */
-    TEST_NUMBER(-1.7976931348623157e+308, "-1.7976931348623157e+308");
-}
-
-#define TEST_STRING(expect, json)\
-    do {\
-        mini_value v;\
-        mini_init(&v);\
-        EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, json));\
-        EXPECT_EQ_INT(MINI_STRING, mini_get_type(&v));\
-        EXPECT_EQ_STRING(expect, mini_get_string(&v), mini_get_string_length(&v));\
-        mini_free(&v);\
-    } while(0)
-
-static void test_parse_string() {
-    TEST_STRING("", "\"\"");
-    TEST_STRING("Hello", "\"Hello\"");
-    TEST_STRING("Hello\nWorld", "\"Hello\\nWorld\"");
-    TEST_STRING("\" \\ / \b \f \n \r \t", "\"\\\" \\\\ \\/ \\b \\f \\n \\r \\t\"");
-    TEST_STRING("Hello\0World", "\"Hello\\u0000World\"");
-    TEST_STRING("\x24", "\"\\u0024\"");         /* Dollar sign U+0024 */
-    TEST_STRING("\xC2\xA2", "\"\\u00A2\"");     /* Cents sign U+00A2 */
-    TEST_STRING("\xE2\x82\xAC", "\"\\u20AC\""); /* Euro sign U+20AC */
-    TEST_STRING("\xF0\x9D\x84\x9E", "\"\\uD834\\uDD1E\"");  /* G clef sign U+1D11E */
-    TEST_STRING("\xF0\x9D\x84\x9E", "\"\\ud834\\udd1e\"");  /* G clef sign U+1D11E */
-}
-
-#define TEST_ERROR(error, json)\
-    do {\
-        mini_value v;\
-        mini_init(&v);\
-        v.type = MINI_FALSE;\
-        EXPECT_EQ_INT(error, mini_parse(&v, json));\
-        EXPECT_EQ_INT(MINI_NULL, mini_get_type(&v));\
-        mini_free(&v);\
-    } while(0)
-
-static void test_parse_expect_value() {
-    TEST_ERROR(MINI_PARSE_EXPECT_VALUE, "");
-    TEST_ERROR(MINI_PARSE_EXPECT_VALUE, " ");
-}
-
-static void test_parse_invalid_value() {
-    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "nul");
-    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "?");
-
-    /* invalid number */
-    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "+0");
-    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "+1");
-    TEST_ERROR(MINI_PARSE_INVALID_VALUE, ".123"); /* at least one digit before '.' */
-    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "1.");   /* at least one digit after '.' */
-    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "INF");
-    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "inf");
-    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "NAN");
-    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "nan");
-}
-
-static void test_parse_root_not_singular() {
-    TEST_ERROR(MINI_PARSE_ROOT_NOT_SINGULAR, "null x");
-
-    /* invalid number */
-    TEST_ERROR(MINI_PARSE_ROOT_NOT_SINGULAR, "0123"); /* after zero should be '.' or nothing */
-    TEST_ERROR(MINI_PARSE_ROOT_NOT_SINGULAR, "0x0");
-    TEST_ERROR(MINI_PARSE_ROOT_NOT_SINGULAR, "0x123");
-}
-
-static void test_parse_number_too_big() {
-    TEST_ERROR(MINI_PARSE_NUMBER_TOO_BIG, "1e309");
-    TEST_ERROR(MINI_PARSE_NUMBER_TOO_BIG, "-1e309");
-}
-
-static void test_parse_missing_quotation_mark() {
-    TEST_ERROR(MINI_PARSE_MISS_QUOTATION_MARK, "\"");
-    TEST_ERROR(MINI_PARSE_MISS_QUOTATION_MARK, "\"abc");
-}
-
-static void test_parse_invalid_string_escape() {
-    TEST_ERROR(MINI_PARSE_INVALID_STRING_ESCAPE, "\"\\v\"");
-    TEST_ERROR(MINI_PARSE_INVALID_STRING_ESCAPE, "\"\\'\"");
-    TEST_ERROR(MINI_PARSE_INVALID_STRING_ESCAPE, "\"\\0\"");
-    TEST_ERROR(MINI_PARSE_INVALID_STRING_ESCAPE, "\"\\x12\"");
-}
-
-static void test_parse_invalid_string_char() {
-    TEST_ERROR(MINI_PARSE_INVALID_STRING_CHAR, "\"\x01\"");
-    TEST_ERROR(MINI_PARSE_INVALID_STRING_CHAR, "\"\x1F\"");
-}
-
-static void test_parse_invalid_unicode_hex() {
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u0\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u01\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u012\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u/000\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\uG000\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u0/00\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u0G00\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u0/00\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u00G0\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u000/\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u000G\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u 123\"");
-}
-
-static void test_parse_invalid_unicode_surrogate() {
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uD800\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uDBFF\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uD800\\\\\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uD800\\uDBFF\"");
-    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uD800\\uE000\"");
-}
-
-static void test_parse_array() {
-    size_t i,j;
-    mini_value v;
-    mini_init(&v);
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "[ ]"));
-    EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(&v));
-    EXPECT_EQ_SIZE_T(0, mini_get_array_size(&v));
-    mini_free(&v);
-
-    mini_init(&v);
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "[ null , false , true , 123 , \"abc\" ]"));
-    EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(&v));
-    EXPECT_EQ_SIZE_T(5, mini_get_array_size(&v));
-    EXPECT_EQ_INT(MINI_NULL,   mini_get_type(mini_get_array_element(&v, 0)));
-    EXPECT_EQ_INT(MINI_FALSE,  mini_get_type(mini_get_array_element(&v, 1)));
-    EXPECT_EQ_INT(MINI_TRUE,   mini_get_type(mini_get_array_element(&v, 2)));
-    EXPECT_EQ_INT(MINI_NUMBER, mini_get_type(mini_get_array_element(&v, 3)));
-    EXPECT_EQ_INT(MINI_STRING, mini_get_type(mini_get_array_element(&v, 4)));
-    EXPECT_EQ_DOUBLE(123.0, mini_get_number(mini_get_array_element(&v, 3)));
-    EXPECT_EQ_STRING("abc", mini_get_string(mini_get_array_element(&v, 4)), mini_get_string_length(mini_get_array_element(&v, 4)));
-    mini_free(&v);
-
-    mini_init(&v);
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "[ [ ] , [ 0 ] , [ 0 , 1 ] , [ 0 , 1 , 2 ] ]"));
-    EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(&v));
-    EXPECT_EQ_SIZE_T(4, mini_get_array_size(&v));
-    for(i = 0; i < 4; i++) {
-        mini_value* a = mini_get_array_element(&v, i);
-        EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(a));
-        EXPECT_EQ_SIZE_T(i, mini_get_array_size(a));
-        for(j = 0; j < i; j++){
-            mini_value* e = mini_get_array_element(a, j);
-            EXPECT_EQ_INT(MINI_NUMBER, mini_get_type(e));
-            EXPECT_EQ_DOUBLE((double)j, mini_get_number(e));
-        }
-    }
-    mini_free(&v);
-}
-
-static void test_parse_object() {
-    mini_value v;
-    size_t i;
-
-    mini_init(&v);
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, " { } "));
-    EXPECT_EQ_INT(MINI_OBJECT, mini_get_type(&v));
-    EXPECT_EQ_SIZE_T(0, mini_get_object_size(&v));
-    mini_free(&v);
-
-    mini_init(&v);
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v,
-                " { "
-                "\"n\" : null , "
-                "\"f\" : false , "
-                "\"t\" : true , "
-                "\"i\" : 123 , "
-                "\"s\" : \"abc\" , "
-                "\"a\" : [ 1, 2, 3 ], "
-                "\"o\" : { \"1\" : 1, \"2\" : 2, \"3\" : 3 }"
-                " } "
-                ));
-    EXPECT_EQ_INT(MINI_OBJECT, mini_get_type(&v));
-    EXPECT_EQ_SIZE_T(7, mini_get_object_size(&v));
-    EXPECT_EQ_INT(MINI_NULL, mini_get_type(mini_get_object_value(&v, "n")));
-    EXPECT_EQ_INT(MINI_TRUE, mini_get_type(mini_get_object_value(&v, "t")));
-    EXPECT_EQ_INT(MINI_FALSE, mini_get_type(mini_get_object_value(&v, "f")));
-    EXPECT_EQ_INT(MINI_NUMBER, mini_get_type(mini_get_object_value(&v, "i")));
-    EXPECT_EQ_DOUBLE(123.0, mini_get_number(mini_get_object_value(&v, "i")));
-    EXPECT_EQ_INT(MINI_STRING, mini_get_type(mini_get_object_value(&v, "s")));
-    EXPECT_EQ_STRING("abc", mini_get_string(mini_get_object_value(&v, "s")), mini_get_string_length(mini_get_object_value(&v, "s")));
-    EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(mini_get_object_value(&v, "a")));
-    EXPECT_EQ_SIZE_T(3, mini_get_array_size(mini_get_object_value(&v, "a")));
-    for (i = 0; i < 3; i++) {
-        mini_value* e = mini_get_array_element(mini_get_object_value(&v, "a"), i);
-        EXPECT_EQ_INT(MINI_NUMBER, mini_get_type(e));
-        EXPECT_EQ_DOUBLE(i + 1.0, mini_get_number(e));
-    }
-
-    mini_value* o = mini_get_object_value(&v, "o");
-    EXPECT_EQ_INT(MINI_OBJECT, mini_get_type(o));
-    EXPECT_EQ_SIZE_T(3, mini_get_object_size(o));
-    /*
-    for(i = 0; i < 3; i++) {
-        mini_value* ov = mini_get_object_value(o, "1");
-        EXPECT_EQ_INT(MINI_NUMBER, mini_get_type(ov));
-        EXPECT_EQ_DOUBLE(i + 1.0, mini_get_number(ov));
-    }
-    */
-    mini_free(&v);
-}
-
-static void test_parse_miss_comma_or_square_bracket() {
-    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[1");
-    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[1}");
-    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[1 2");
-    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[[]");
-}
-
-static void test_parse_miss_key() {
-    TEST_ERROR(MINI_PARSE_MISS_KEY, "{:1,");
-    TEST_ERROR(MINI_PARSE_MISS_KEY, "{1:1,");
-    TEST_ERROR(MINI_PARSE_MISS_KEY, "{true:1,");
-    TEST_ERROR(MINI_PARSE_MISS_KEY, "{false:1,");
-    TEST_ERROR(MINI_PARSE_MISS_KEY, "{null:1,");
-    TEST_ERROR(MINI_PARSE_MISS_KEY, "{[]:1,");
-    TEST_ERROR(MINI_PARSE_MISS_KEY, "{{}:1,");
-    TEST_ERROR(MINI_PARSE_MISS_KEY, "{\"a\":1,");
-}
-
-static void test_parse_miss_colon() {
-    TEST_ERROR(MINI_PARSE_MISS_COLON, "{\"a\"}");
-    TEST_ERROR(MINI_PARSE_MISS_COLON, "{\"a\",\"b\"}");
-}
-
-static void test_parse_miss_comma_or_curly_bracket() {
-    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":1");
-    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":1]");
-    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":1 \"b\"");
-    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":{}");
-}
-
-static void test_parse() {
-    test_parse_null();
-    test_parse_true();
-    test_parse_false();
-    test_parse_number();
-    test_parse_string();
-    test_parse_expect_value();
-    test_parse_invalid_value();
-    test_parse_root_not_singular();
-    test_parse_number_too_big();
-    test_parse_missing_quotation_mark();
-    test_parse_invalid_string_escape();
-    test_parse_invalid_string_char();
-    test_parse_invalid_unicode_hex();
-    test_parse_invalid_unicode_surrogate();
-    test_parse_array();
-    test_parse_object();
-    test_parse_miss_comma_or_square_bracket();
-    test_parse_miss_key();
-    test_parse_miss_colon();
-    test_parse_miss_comma_or_curly_bracket();
-}
-
-#define TEST_ROUNDTRIP(json)\
-        do {\
-                    mini_value v;\
-                    char* json2;\
-                    size_t length;\
-                    mini_init(&v);\
-                    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, json));\
-                    mini_generate(&v, &json2, &length);\
-                    EXPECT_EQ_STRING(json, json2, length);\
-                    mini_free(&v);\
-                    free(json2);\
-                } while(0)
-
-static void test_creater_number() {
-    TEST_ROUNDTRIP("0");
-    TEST_ROUNDTRIP("-0");
-    TEST_ROUNDTRIP("1");
-    TEST_ROUNDTRIP("-1");
-    TEST_ROUNDTRIP("1.5");
-    TEST_ROUNDTRIP("-1.5");
-    TEST_ROUNDTRIP("3.25");
-    TEST_ROUNDTRIP("1e+20");
-    TEST_ROUNDTRIP("1.234e+20");
-    TEST_ROUNDTRIP("1.234e-20");
-    TEST_ROUNDTRIP("1.0000000000000002"); /* the smallest number > 1 */
-    TEST_ROUNDTRIP("4.9406564584124654e-324"); /* minimum denormal */
-    TEST_ROUNDTRIP("-4.9406564584124654e-324");
-    TEST_ROUNDTRIP("2.2250738585072009e-308");  /* Max subnormal double */
-    TEST_ROUNDTRIP("-2.2250738585072009e-308");
-    TEST_ROUNDTRIP("2.2250738585072014e-308");  /* Min normal positive double */
-    TEST_ROUNDTRIP("-2.2250738585072014e-308");
-    TEST_ROUNDTRIP("1.7976931348623157e+308");  /* Max double */
-    TEST_ROUNDTRIP("-1.7976931348623157e+308");
-}
-
-static void test_creater_string() {
-    TEST_ROUNDTRIP("\"\"");
-    TEST_ROUNDTRIP("\"Hello\"");
-    TEST_ROUNDTRIP("\"Hello\\nWorld\"");
-    TEST_ROUNDTRIP("\"\\\" \\\\ / \\b \\f \\n \\r \\t\"");
-    TEST_ROUNDTRIP("\"Hello\\u0000World\"");
-}
-
-static void test_creater_array() {
-    TEST_ROUNDTRIP("[]");
-    TEST_ROUNDTRIP("[null,false,true,123,\"abc\",[1,2,3]]");
-}
-
-static void test_creater_object() {
-    TEST_ROUNDTRIP("{}");
-    //TEST_ROUNDTRIP("{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3}}");
-    //TEST_ROUNDTRIP("{\"a\":[1,2,3],\"f\":false,\"i\":123,\"n\":null,\"o\":{\"1\":1,\"2\":2,\"3\":3},\"s\":\"abc\",\"t\":true}");
-}
-
-static void test_creater() {
-#if 1
-    TEST_ROUNDTRIP("null");
-    TEST_ROUNDTRIP("false");
-    TEST_ROUNDTRIP("true");
-    test_creater_number();
-    test_creater_string();
-    test_creater_array();
-#endif
-    test_creater_object();
-}
-
-static void test_access_null() {
-    mini_value v;
-    mini_init(&v);
-    mini_set_string(&v, "a", 1);
-    mini_set_null(&v);
-    EXPECT_EQ_INT(MINI_NULL, mini_get_type(&v));
-    mini_free(&v);
-}
-
-static void test_access_boolean() {
-    mini_value v;
-    mini_init(&v);
-    mini_set_string(&v, "a", 1);
-    mini_set_boolean(&v, 1);
-    EXPECT_TRUE(mini_get_boolean(&v));
-    mini_set_boolean(&v, 0);
-    EXPECT_FALSE(mini_get_boolean(&v));
-    mini_free(&v);
-}
-
-static void test_access_number() {
-    mini_value v;
-    mini_init(&v);
-    mini_set_string(&v, "a", 1);
-    mini_set_number(&v, 1234.5);
-    EXPECT_EQ_DOUBLE(1234.5, mini_get_number(&v));
-    mini_free(&v);
-}
-
-static void test_access_string() {
-    mini_value v;
-    mini_init(&v);
-    mini_set_string(&v, "", 0);
-    EXPECT_EQ_STRING("", mini_get_string(&v), mini_get_string_length(&v));
-    mini_set_string(&v, "Hello", 5);
-    EXPECT_EQ_STRING("Hello", mini_get_string(&v), mini_get_string_length(&v));
-    mini_free(&v);
-}
-
-static void test_access() {
-    test_access_null();
-    test_access_boolean();
-    test_access_number();
-    test_access_string();
-}
-
-static void test_add_value_to_array() {
-    mini_value arr, v;
-    mini_init_array(&arr);
-    EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(&arr));
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&arr, "[ null,false,true,\"ab\" ]"));
-    EXPECT_EQ_SIZE_T(4, mini_get_array_size(&arr));
-    
-    mini_init(&v);
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "\"abc\""));
-    EXPECT_EQ_INT(MINI_STRING, mini_get_type(&v));
-    mini_add_value_to_array(&arr, &v);
-    EXPECT_EQ_SIZE_T(5, mini_get_array_size(&arr));
-    mini_free(&v);
-
-    mini_init(&v);
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "[ \"a\", \"b\" ]"));
-    EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(&v));
-    mini_add_value_to_array(&arr, &v);
-    EXPECT_EQ_SIZE_T(6, mini_get_array_size(&arr));
-    mini_free(&v);
-    
-    mini_init(&v);
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "{ \"object\" : [ 4, 5, \"6\" ] }"));
-    EXPECT_EQ_INT(MINI_OBJECT, mini_get_type(&v));
-    mini_add_value_to_array(&arr, &v);
-    EXPECT_EQ_SIZE_T(7, mini_get_array_size(&arr));
-    mini_free(&v);
-
-    //mini_show_value(&arr);
-    mini_free(&arr);
-}
-
-static void test_add_value_to_object() {
-    mini_value obj, key, val;
-    //mini_init_object(&obj);
-    //EXPECT_EQ_INT(MINI_OBJECT, mini_get_type(&obj));
-
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&obj, "{ \"a\" : \"apple\" }"));
-    EXPECT_EQ_SIZE_T(1, mini_get_object_size(&obj));
-
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&key, "\"c\""));
-    EXPECT_EQ_INT(MINI_STRING, mini_get_type(&key));
-    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&val, "[ \"cat\", 2 ]"));
-    EXPECT_EQ_SIZE_T(2, mini_get_array_size(&val));
-    mini_add_value_to_object(&obj, &key, &val);
-    EXPECT_EQ_SIZE_T(2, mini_get_object_size(&obj));
-    mini_free(&key);
-    mini_free(&val);
-
-    //mini_show_value(&obj);
-    mini_free(&obj);
-}
-
-static void test_interface() {
-    test_add_value_to_array();
-    test_add_value_to_object();
-}
-
-int main() {
-    test_parse();
-    test_creater();
-    test_access();
-    test_interface();
-    printf("%d/%d (%3.2f%%) passed\n", test_pass, test_count, test_pass * 100.0 / test_count);
-    return main_ret;
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "./json/mini_json.h"
+
+static int main_ret = 0;
+static int test_count = 0;
+static int test_pass = 0;
+
+#define EXPECT_EQ_BASE(equality, expect, actual, format) \
+    do {\
+        test_count++;\
+        if (equality)\
+            test_pass++;\
+        else {\
+            fprintf(stderr, "%s:%d: expect: " format " actual: " format "\n", __FILE__, __LINE__, expect, actual);\
+            main_ret = 1;\
+        }\
+    } while(0)
+
+#define EXPECT_EQ_INT(expect, actual) EXPECT_EQ_BASE((expect) == (actual), expect, actual, "%d")
+#define EXPECT_EQ_DOUBLE(expect, actual) EXPECT_EQ_BASE((expect) == (actual), expect, actual, "%.17g")
+#define EXPECT_EQ_STRING(expect, actual, alength) \
+    EXPECT_EQ_BASE(sizeof(expect) - 1 == alength && memcmp(expect, actual, alength) == 0, expect, actual, "%s")
+#define EXPECT_TRUE(actual) EXPECT_EQ_BASE((actual) != 0, "true", "false", "%s")
+#define EXPECT_FALSE(actual) EXPECT_EQ_BASE((actual) == 0, "false", "true", "%s")
+#define EXPECT_EQ_SIZE_T(expect, actual) EXPECT_EQ_BASE((expect) == (actual), (size_t)expect, (size_t)actual, "%zu")
+
+
+static void test_parse_null() {
+    mini_value v;
+    mini_init(&v);
+    mini_set_boolean(&v, 0);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "null"));
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(&v));
+    mini_free(&v);
+}
+
+static void test_parse_true() {
+    mini_value v;
+    mini_init(&v);
+    mini_set_boolean(&v, 0);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "true"));
+    EXPECT_EQ_INT(MINI_TRUE, mini_get_type(&v));
+    mini_free(&v);
+}
+
+static void test_parse_false() {
+    mini_value v;
+    mini_init(&v);
+    mini_set_boolean(&v, 1);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "false"));
+    EXPECT_EQ_INT(MINI_FALSE, mini_get_type(&v));
+    mini_free(&v);
+}
+
+#define TEST_NUMBER(expect, json)\
+    do {\
+        mini_value v;\
+        mini_init(&v);\
+        EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, json));\
+        EXPECT_EQ_INT(MINI_NUMBER, mini_get_type(&v));\
+        EXPECT_EQ_DOUBLE(expect, mini_get_number(&v));\
+        mini_free(&v);\
+    } while(0)
+
+static void test_parse_number() {
+    TEST_NUMBER(0.0, "0");
+    TEST_NUMBER(0.0, "-0");
+    TEST_NUMBER(0.0, "-0.0");
+    TEST_NUMBER(1.0, "1");
+    TEST_NUMBER(-1.0, "-1");
+    TEST_NUMBER(1.5, "1.5");
+    TEST_NUMBER(-1.5, "-1.5");
+    TEST_NUMBER(3.1416, "3.1416");
+    TEST_NUMBER(1E10, "1E10");
+    TEST_NUMBER(1e10, "1e10");
+    TEST_NUMBER(1E+10, "1E+10");
+    TEST_NUMBER(1E-10, "1E-10");
+    TEST_NUMBER(-1E10, "-1E10");
+    TEST_NUMBER(-1e10, "-1e10");
+    TEST_NUMBER(-1E+10, "-1E+10");
+    TEST_NUMBER(-1E-10, "-1E-10");
+    TEST_NUMBER(1.234E+10, "1.234E+10");
+    TEST_NUMBER(1.234E-10, "1.234E-10");
+    TEST_NUMBER(0.0, "1e-10000"); /* must underflow */
+
+    TEST_NUMBER(1.0000000000000002, "1.0000000000000002"); /* the smallest number > 1 */
+    TEST_NUMBER( 4.9406564584124654e-324, "4.9406564584124654e-324"); /* minimum denormal */
+    TEST_NUMBER(-4.9406564584124654e-324, "-4.9406564584124654e-324");
+    TEST_NUMBER( 2.2250738585072009e-308, "2.2250738585072009e-308");  /* Max subnormal double */
+    TEST_NUMBER(-2.2250738585072009e-308, "-2.2250738585072009e-308");
+    TEST_NUMBER( 2.2250738585072014e-308, "2.2250738585072014e-308");  /* Min normal positive double */
+    TEST_NUMBER(-2.2250738585072014e-308, "-2.2250738585072014e-308");
+    TEST_NUMBER( 1.7976931348623157e+308, "1.7976931348623157e+308");  /* Max double */
+    TEST_NUMBER(-1.7976931348623157e+308, "-1.7976931348623157e+308");
+
+    /* ties, truncated mantissas and the slow path */
+    TEST_NUMBER(9007199254740992.0, "9007199254740993"); /* 2^53 + 1 ties to even */
+    TEST_NUMBER(9007199254740994.0, "9007199254740993.0000000001");
+    TEST_NUMBER(9007199254740996.0, "9007199254740995");
+    TEST_NUMBER(0.1, "0.1000000000000000055511151231257827021181583404541015625");
+    TEST_NUMBER(2.2250738585072011e-308, "2.2250738585072011e-308");
+    TEST_NUMBER(0.0, "2.4703282292062327e-324"); /* just below half the minimum denormal */
+    TEST_NUMBER(4.9406564584124654e-324, "2.4703282292062328e-324");
+    TEST_NUMBER(1.7976931348623157e+308, "1.7976931348623158e+308");
+    TEST_NUMBER(1.2345678901234568e-1, "123456789012345678901234567890e-30");
+    TEST_NUMBER(1e-300, "0.000000000000000000000000000000000000000000001e-255");
+    TEST_NUMBER(1e-100, "100000000000000000000000000000000000000000000000000000000000000000000000001e-174");
+}
+
+/* every kind of decimal text must read exactly like strtod */
+static void test_parse_number_exact() {
+    unsigned long long x = 88172645463325252ULL;
+    char json[64];
+    int i, j, n, mismatches = 0;
+    mini_value v;
+    mini_init(&v);
+    for(i = 0; i < 100000; i++) {
+        double d;
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        memcpy(&d, &x, sizeof(d));
+        switch(i % 3) {
+            case 0: /* shortest round trip of a random double */
+                if(d != d || d - d != 0) continue;
+                sprintf(json, "%.17g", d);
+                break;
+            case 1: /* fewer digits than a double holds */
+                if(d != d || d - d != 0) continue;
+                sprintf(json, "%.*e", (int)(x >> 59), d);
+                break;
+            default: /* more digits than fit the 64-bit mantissa */
+                n = sprintf(json, "%llu.", x);
+                for(j = 0; j < 12; j++)
+                    json[n++] = (char)('0' + (x >> (j * 5)) % 10);
+                sprintf(json + n, "e%d", (int)(x % 600) - 330);
+                break;
+        }
+        if(mini_parse(&v, json) != MINI_PARSE_OK || mini_get_number(&v) != strtod(json, NULL))
+            mismatches++;
+    }
+    EXPECT_EQ_INT(0, mismatches);
+}
+
+#define TEST_STRING(expect, json)\
+    do {\
+        mini_value v;\
+        mini_init(&v);\
+        EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, json));\
+        EXPECT_EQ_INT(MINI_STRING, mini_get_type(&v));\
+        EXPECT_EQ_STRING(expect, mini_get_string(&v), mini_get_string_length(&v));\
+        mini_free(&v);\
+    } while(0)
+
+static void test_parse_string() {
+    TEST_STRING("", "\"\"");
+    TEST_STRING("Hello", "\"Hello\"");
+    TEST_STRING("Hello\nWorld", "\"Hello\\nWorld\"");
+    TEST_STRING("\" \\ / \b \f \n \r \t", "\"\\\" \\\\ \\/ \\b \\f \\n \\r \\t\"");
+    TEST_STRING("Hello\0World", "\"Hello\\u0000World\"");
+    TEST_STRING("\x24", "\"\\u0024\"");         /* Dollar sign U+0024 */
+    TEST_STRING("\xC2\xA2", "\"\\u00A2\"");     /* Cents sign U+00A2 */
+    TEST_STRING("\xE2\x82\xAC", "\"\\u20AC\""); /* Euro sign U+20AC */
+    TEST_STRING("\xF0\x9D\x84\x9E", "\"\\uD834\\uDD1E\"");  /* G clef sign U+1D11E */
+    TEST_STRING("\xF0\x9D\x84\x9E", "\"\\ud834\\udd1e\"");  /* G clef sign U+1D11E */
+}
+
+#define TEST_ERROR(error, json)\
+    do {\
+        mini_value v;\
+        mini_init(&v);\
+        v.type = MINI_FALSE;\
+        EXPECT_EQ_INT(error, mini_parse(&v, json));\
+        EXPECT_EQ_INT(MINI_NULL, mini_get_type(&v));\
+        mini_free(&v);\
+    } while(0)
+
+static void test_parse_expect_value() {
+    TEST_ERROR(MINI_PARSE_EXPECT_VALUE, "");
+    TEST_ERROR(MINI_PARSE_EXPECT_VALUE, " ");
+}
+
+static void test_parse_invalid_value() {
+    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "nul");
+    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "?");
+
+    /* invalid number */
+    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "+0");
+    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "+1");
+    TEST_ERROR(MINI_PARSE_INVALID_VALUE, ".123"); /* at least one digit before '.' */
+    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "1.");   /* at least one digit after '.' */
+    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "INF");
+    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "inf");
+    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "NAN");
+    TEST_ERROR(MINI_PARSE_INVALID_VALUE, "nan");
+}
+
+static void test_parse_root_not_singular() {
+    TEST_ERROR(MINI_PARSE_ROOT_NOT_SINGULAR, "null x");
+
+    /* invalid number */
+    TEST_ERROR(MINI_PARSE_ROOT_NOT_SINGULAR, "0123"); /* after zero should be '.' or nothing */
+    TEST_ERROR(MINI_PARSE_ROOT_NOT_SINGULAR, "0x0");
+    TEST_ERROR(MINI_PARSE_ROOT_NOT_SINGULAR, "0x123");
+}
+
+static void test_parse_number_too_big() {
+    TEST_ERROR(MINI_PARSE_NUMBER_TOO_BIG, "1e309");
+    TEST_ERROR(MINI_PARSE_NUMBER_TOO_BIG, "-1e309");
+}
+
+static void test_parse_missing_quotation_mark() {
+    TEST_ERROR(MINI_PARSE_MISS_QUOTATION_MARK, "\"");
+    TEST_ERROR(MINI_PARSE_MISS_QUOTATION_MARK, "\"abc");
+}
+
+static void test_parse_invalid_string_escape() {
+    TEST_ERROR(MINI_PARSE_INVALID_STRING_ESCAPE, "\"\\v\"");
+    TEST_ERROR(MINI_PARSE_INVALID_STRING_ESCAPE, "\"\\'\"");
+    TEST_ERROR(MINI_PARSE_INVALID_STRING_ESCAPE, "\"\\0\"");
+    TEST_ERROR(MINI_PARSE_INVALID_STRING_ESCAPE, "\"\\x12\"");
+}
+
+static void test_parse_invalid_string_char() {
+    TEST_ERROR(MINI_PARSE_INVALID_STRING_CHAR, "\"\x01\"");
+    TEST_ERROR(MINI_PARSE_INVALID_STRING_CHAR, "\"\x1F\"");
+}
+
+static void test_parse_invalid_unicode_hex() {
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u0\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u01\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u012\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u/000\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\uG000\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u0/00\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u0G00\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u0/00\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u00G0\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u000/\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u000G\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_HEX, "\"\\u 123\"");
+}
+
+static void test_parse_invalid_unicode_surrogate() {
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uD800\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uDBFF\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uD800\\\\\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uD800\\uDBFF\"");
+    TEST_ERROR(MINI_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uD800\\uE000\"");
+}
+
+static void test_parse_array() {
+    size_t i,j;
+    mini_value v;
+    mini_init(&v);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "[ ]"));
+    EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(&v));
+    EXPECT_EQ_SIZE_T(0, mini_get_array_size(&v));
+    mini_free(&v);
+
+    mini_init(&v);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "[ null , false , true , 123 , \"abc\" ]"));
+    EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(&v));
+    EXPECT_EQ_SIZE_T(5, mini_get_array_size(&v));
+    EXPECT_EQ_INT(MINI_NULL,   mini_get_type(mini_get_array_element(&v, 0)));
+    EXPECT_EQ_INT(MINI_FALSE,  mini_get_type(mini_get_array_element(&v, 1)));
+    EXPECT_EQ_INT(MINI_TRUE,   mini_get_type(mini_get_array_element(&v, 2)));
+    EXPECT_EQ_INT(MINI_NUMBER, mini_get_type(mini_get_array_element(&v, 3)));
+    EXPECT_EQ_INT(MINI_STRING, mini_get_type(mini_get_array_element(&v, 4)));
+    EXPECT_EQ_DOUBLE(123.0, mini_get_number(mini_get_array_element(&v, 3)));
+    EXPECT_EQ_STRING("abc", mini_get_string(mini_get_array_element(&v, 4)), mini_get_string_length(mini_get_array_element(&v, 4)));
+    mini_free(&v);
+
+    mini_init(&v);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "[ [ ] , [ 0 ] , [ 0 , 1 ] , [ 0 , 1 , 2 ] ]"));
+    EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(&v));
+    EXPECT_EQ_SIZE_T(4, mini_get_array_size(&v));
+    for(i = 0; i < 4; i++) {
+        mini_value* a = mini_get_array_element(&v, i);
+        EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(a));
+        EXPECT_EQ_SIZE_T(i, mini_get_array_size(a));
+        for(j = 0; j < i; j++){
+            mini_value* e = mini_get_array_element(a, j);
+            EXPECT_EQ_INT(MINI_NUMBER, mini_get_type(e));
+            EXPECT_EQ_DOUBLE((double)j, mini_get_number(e));
+        }
+    }
+    mini_free(&v);
+}
+
+static void test_parse_object() {
+    mini_value v;
+    size_t i;
+
+    mini_init(&v);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, " { } "));
+    EXPECT_EQ_INT(MINI_OBJECT, mini_get_type(&v));
+    EXPECT_EQ_SIZE_T(0, mini_get_object_size(&v));
+    mini_free(&v);
+
+    mini_init(&v);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v,
+                " { "
+                "\"n\" : null , "
+                "\"f\" : false , "
+                "\"t\" : true , "
+                "\"i\" : 123 , "
+                "\"s\" : \"abc\" , "
+                "\"a\" : [ 1, 2, 3 ], "
+                "\"o\" : { \"1\" : 1, \"2\" : 2, \"3\" : 3 }"
+                " } "
+                ));
+    EXPECT_EQ_INT(MINI_OBJECT, mini_get_type(&v));
+    EXPECT_EQ_SIZE_T(7, mini_get_object_size(&v));
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(mini_get_object_value(&v, "n")));
+    EXPECT_EQ_INT(MINI_TRUE, mini_get_type(mini_get_object_value(&v, "t")));
+    EXPECT_EQ_INT(MINI_FALSE, mini_get_type(mini_get_object_value(&v, "f")));
+    EXPECT_EQ_INT(MINI_NUMBER, mini_get_type(mini_get_object_value(&v, "i")));
+    EXPECT_EQ_DOUBLE(123.0, mini_get_number(mini_get_object_value(&v, "i")));
+    EXPECT_EQ_INT(MINI_STRING, mini_get_type(mini_get_object_value(&v, "s")));
+    EXPECT_EQ_STRING("abc", mini_get_string(mini_get_object_value(&v, "s")), mini_get_string_length(mini_get_object_value(&v, "s")));
+    EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(mini_get_object_value(&v, "a")));
+    EXPECT_EQ_SIZE_T(3, mini_get_array_size(mini_get_object_value(&v, "a")));
+    for (i = 0; i < 3; i++) {
+        mini_value* e = mini_get_array_element(mini_get_object_value(&v, "a"), i);
+        EXPECT_EQ_INT(MINI_NUMBER, mini_get_type(e));
+        EXPECT_EQ_DOUBLE(i + 1.0, mini_get_number(e));
+    }
+
+    mini_value* o = mini_get_object_value(&v, "o");
+    EXPECT_EQ_INT(MINI_OBJECT, mini_get_type(o));
+    EXPECT_EQ_SIZE_T(3, mini_get_object_size(o));
+    /*
+    for(i = 0; i < 3; i++) {
+        mini_value* ov = mini_get_object_value(o, "1");
+        EXPECT_EQ_INT(MINI_NUMBER, mini_get_type(ov));
+        EXPECT_EQ_DOUBLE(i + 1.0, mini_get_number(ov));
+    }
+    */
+    mini_free(&v);
+}
+
+static void test_parse_miss_comma_or_square_bracket() {
+    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[1");
+    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[1}");
+    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[1 2");
+    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[[]");
+}
+
+static void test_parse_miss_key() {
+    TEST_ERROR(MINI_PARSE_MISS_KEY, "{:1,");
+    TEST_ERROR(MINI_PARSE_MISS_KEY, "{1:1,");
+    TEST_ERROR(MINI_PARSE_MISS_KEY, "{true:1,");
+    TEST_ERROR(MINI_PARSE_MISS_KEY, "{false:1,");
+    TEST_ERROR(MINI_PARSE_MISS_KEY, "{null:1,");
+    TEST_ERROR(MINI_PARSE_MISS_KEY, "{[]:1,");
+    TEST_ERROR(MINI_PARSE_MISS_KEY, "{{}:1,");
+    TEST_ERROR(MINI_PARSE_MISS_KEY, "{\"a\":1,");
+}
+
+static void test_parse_miss_colon() {
+    TEST_ERROR(MINI_PARSE_MISS_COLON, "{\"a\"}");
+    TEST_ERROR(MINI_PARSE_MISS_COLON, "{\"a\",\"b\"}");
+}
+
+static void test_parse_miss_comma_or_curly_bracket() {
+    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":1");
+    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":1]");
+    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":1 \"b\"");
+    TEST_ERROR(MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":{}");
+}
+
+/* nesting up to MINI_PARSE_MAX_DEPTH parses, one more level fails in every entry point */
+static void test_parse_too_deep() {
+    const size_t unit = 6;  /* "{\"a\":[" */
+    char* json = (char*)malloc((MINI_PARSE_MAX_DEPTH + 1) * unit + 8);
+    mini_document doc;
+    mini_value v;
+    size_t i, n;
+    for(n = MINI_PARSE_MAX_DEPTH; n <= MINI_PARSE_MAX_DEPTH + 1; n++) {
+        int ret = n > MINI_PARSE_MAX_DEPTH ? MINI_PARSE_TOO_DEEP : MINI_PARSE_OK;
+        char* p = json;
+        for(i = 0; i < n; i++) {
+            memcpy(p, i % 2 ? "[" : "{\"a\":", i % 2 ? 1 : 5);
+            p += i % 2 ? 1 : 5;
+        }
+        *p++ = '1';
+        for(i = n; i-- > 0; )
+            *p++ = i % 2 ? ']' : '}';
+        *p = '\0';
+        mini_init(&v);
+        EXPECT_EQ_INT(ret, mini_parse(&v, json));
+        mini_free(&v);
+        EXPECT_EQ_INT(ret, mini_parse_indexed(&v, json, (size_t)(p - json)));
+        mini_free(&v);
+        EXPECT_EQ_INT(ret, mini_parse_document(&doc, json));
+        mini_free_document(&doc);
+        EXPECT_EQ_INT(ret, mini_parse_lazy(&doc, json));
+        mini_free_document(&doc);
+    }
+    /* the open containers are freed when the innermost one fails */
+    memset(json, '[', MINI_PARSE_MAX_DEPTH - 1);
+    strcpy(json + MINI_PARSE_MAX_DEPTH - 1, "\"x\", \"y\", {\"k\":");
+    TEST_ERROR(MINI_PARSE_EXPECT_VALUE, json);
+    json[MINI_PARSE_MAX_DEPTH - 2] = '{';
+    strcpy(json + MINI_PARSE_MAX_DEPTH - 1, "\"key longer than sixteen\" ");
+    TEST_ERROR(MINI_PARSE_MISS_COLON, json);
+    free(json);
+}
+
+/* whitespace runs and string bodies of every length at every alignment */
+static void test_parse_scan() {
+    static const char ws[] = " \t\n\r";
+    char* json = (char*)malloc(256);
+    size_t off, n, i;
+    mini_value v;
+    mini_init(&v);
+    for(off = 0; off < 32; off++) {
+        for(n = 0; n < 80; n++) {
+            char* p = json + off;
+            for(i = 0; i < n; i++)
+                *p++ = ws[i % 4];
+            *p++ = '\"';
+            for(i = 0; i < n; i++)
+                *p++ = (char)('a' + i % 26);
+            strcpy(p, "\"\n ");
+            EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, json + off));
+            EXPECT_EQ_SIZE_T(n, mini_get_string_length(&v));
+            EXPECT_TRUE(n == 0 || mini_get_string(&v)[n - 1] == (char)('a' + (n - 1) % 26));
+
+            mini_free(&v);
+            if(n == 0)
+                continue;
+            /* a stop character at the very end of the run */
+            p[-1] = '\x1F';
+            EXPECT_EQ_INT(MINI_PARSE_INVALID_STRING_CHAR, mini_parse(&v, json + off));
+            p[-1] = '\\';
+            strcpy(p, "n\"");
+            EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, json + off));
+            EXPECT_TRUE(mini_get_string(&v)[n - 1] == '\n');
+            mini_free(&v);
+            p[-1] = 'x';
+            p[0] = '\0';
+            EXPECT_EQ_INT(MINI_PARSE_MISS_QUOTATION_MARK, mini_parse(&v, json + off));
+        }
+    }
+    free(json);
+}
+
+typedef struct {
+    char trace[256];
+    size_t len, events, stop_at;
+}test_sax_state;
+
+static int test_sax_event(test_sax_state* st, const char* text, size_t len) {
+    memcpy(st->trace + st->len, text, len);
+    st->trace[st->len += len] = '\0';
+    return ++st->events == st->stop_at;
+}
+
+static int test_sax_null(void* user) { return test_sax_event((test_sax_state*)user, "n", 1); }
+static int test_sax_boolean(void* user, int b) { return test_sax_event((test_sax_state*)user, b ? "t" : "f", 1); }
+static int test_sax_start_object(void* user) { return test_sax_event((test_sax_state*)user, "{", 1); }
+static int test_sax_start_array(void* user) { return test_sax_event((test_sax_state*)user, "[", 1); }
+
+static int test_sax_number(void* user, const mini_number* n) {
+    char buf[32];
+    size_t len = n->kind == MINI_NUMBER_INT64 ? (size_t)sprintf(buf, "i%lld", (long long)n->v.i) : (size_t)sprintf(buf, "d%g", n->v.d);
+    return test_sax_event((test_sax_state*)user, buf, len);
+}
+
+static int test_sax_text(test_sax_state* st, const char* tag, const char* s, size_t len) {
+    memcpy(st->trace + st->len, tag, 2);
+    st->len += 2;
+    return test_sax_event(st, s, len);
+}
+
+static int test_sax_string(void* user, const char* s, size_t len) { return test_sax_text((test_sax_state*)user, "s:", s, len); }
+static int test_sax_key(void* user, const char* s, size_t len) { return test_sax_text((test_sax_state*)user, "k:", s, len); }
+
+static int test_sax_end_object(void* user, size_t members) {
+    char buf[16];
+    return test_sax_event((test_sax_state*)user, buf, sprintf(buf, "}%u", (unsigned)members));
+}
+
+static int test_sax_end_array(void* user, size_t elements) {
+    char buf[16];
+    return test_sax_event((test_sax_state*)user, buf, sprintf(buf, "]%u", (unsigned)elements));
+}
+
+static void test_parse_sax() {
+    static const mini_handler handler = {
+        test_sax_null, test_sax_boolean, test_sax_number, test_sax_string,
+        test_sax_start_object, test_sax_key, test_sax_end_object,
+        test_sax_start_array, test_sax_end_array
+    };
+    static const mini_handler keys_only = { NULL, NULL, NULL, NULL, NULL, test_sax_key, NULL, NULL, NULL };
+    static const char json[] = " { \"a\" : [ null, true, false, 12, 1.5, \"x\\ty\" ], \"o\" : { }, \"e\" : [ ] } ";
+    test_sax_state st;
+
+    memset(&st, 0, sizeof(st));
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse_sax(json, &handler, &st));
+    EXPECT_EQ_STRING("{k:a[ntfi12d1.5s:x\ty]6k:o{}0k:e[]0}3", st.trace, st.len);
+
+    memset(&st, 0, sizeof(st));
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse_sax(json, &keys_only, &st));
+    EXPECT_EQ_STRING("k:ak:ok:e", st.trace, st.len);
+
+    /* the handler stops the parse */
+    memset(&st, 0, sizeof(st));
+    st.stop_at = 4;
+    EXPECT_EQ_INT(MINI_PARSE_STOPPED, mini_parse_sax(json, &handler, &st));
+    EXPECT_EQ_STRING("{k:a[n", st.trace, st.len);
+
+    /* errors are those of mini_parse */
+    memset(&st, 0, sizeof(st));
+    EXPECT_EQ_INT(MINI_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, mini_parse_sax("[1 2]", &handler, &st));
+    memset(&st, 0, sizeof(st));
+    EXPECT_EQ_INT(MINI_PARSE_ROOT_NOT_SINGULAR, mini_parse_sax("\"a\" x", &handler, &st));
+    memset(&st, 0, sizeof(st));
+    EXPECT_EQ_INT(MINI_PARSE_MISS_COLON, mini_parse_sax("{\"a-long-key-name-here\" 1}", &handler, &st));
+}
+
+static void test_parse_len() {
+    static const char* const docs[] = {
+        "  null ", "true", "-1.5e+10", "18446744073709551616", "123456789012345678901234567890",
+        "\"Hello\\u0000World\"", "\"\\uD834\\uDD1E\\t\\\"\"", "\"0123456789abcdefghijklmnopqrstuvwxyz0123456789\"",
+        "[ 1, [ 2, \"x\" ], { \"k\" : false } ]  \n", "{ \"key longer than sixteen\" : [ 0.5 ] }"
+    };
+    size_t page = (size_t)sysconf(_SC_PAGESIZE), i, k, n;
+    char* mem = (char*)mmap(NULL, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    char* copy;
+    mini_value expect, actual;
+
+    /* every prefix ends right before an unmapped page */
+    mprotect(mem + page, page, PROT_NONE);
+    for(i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+        n = strlen(docs[i]);
+        for(k = 0; k <= n; k++) {
+            int ret;
+            char *expect_json, *actual_json;
+            size_t expect_len, actual_len;
+            copy = (char*)malloc(k + 1);
+            memcpy(copy, docs[i], k);
+            copy[k] = '\0';
+            mini_init(&expect);
+            ret = mini_parse(&expect, copy);
+            free(copy);
+            memcpy(mem + page - k, docs[i], k);
+            mini_init(&actual);
+            EXPECT_EQ_INT(ret, mini_parse_len(&actual, mem + page - k, k));
+            if(ret == MINI_PARSE_OK) {
+                mini_generate(&expect, &expect_json, &expect_len);
+                mini_generate(&actual, &actual_json, &actual_len);
+                EXPECT_TRUE(actual_len == expect_len && memcmp(expect_json, actual_json, actual_len) == 0);
+                free(expect_json);
+                free(actual_json);
+            }
+            mini_free(&expect);
+            mini_free(&actual);
+        }
+    }
+    munmap(mem, 2 * page);
+
+    /* '\0' is an ordinary byte */
+    mini_init(&actual);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse_len(&actual, "123456", 3));
+    EXPECT_EQ_INT(123, (int)mini_get_int64(&actual));
+    EXPECT_EQ_INT(MINI_PARSE_ROOT_NOT_SINGULAR, mini_parse_len(&actual, "1 \0 2", 5));
+    EXPECT_EQ_INT(MINI_PARSE_INVALID_STRING_CHAR, mini_parse_len(&actual, "\"a\0b\"", 5));
+    EXPECT_EQ_INT(MINI_PARSE_INVALID_VALUE, mini_parse_len(&actual, "[\0]", 3));
+    EXPECT_EQ_INT(MINI_PARSE_EXPECT_VALUE, mini_parse_len(&actual, NULL, 0));
+}
+
+/* feeds json in a first piece of first bytes and then pieces of step, each in its own exact-size buffer */
+static int test_push_parse(mini_value* v, const char* json, size_t first, size_t step) {
+    mini_push p;
+    mini_builder b;
+    size_t i, n, len = strlen(json);
+    int ret = MINI_PARSE_OK;
+    mini_builder_init(&b);
+    mini_push_init(&p, &mini_builder_handler, &b);
+    for(i = 0; i < len && ret == MINI_PARSE_OK; i += n) {
+        char* chunk;
+        n = i == 0 ? first : step;
+        if(n > len - i)
+            n = len - i;
+        chunk = (char*)malloc(n);
+        memcpy(chunk, json + i, n);
+        ret = mini_push_feed(&p, chunk, n);
+        free(chunk);
+    }
+    if(ret == MINI_PARSE_OK)
+        ret = mini_push_finish(&p);
+    mini_push_free(&p);
+    mini_init(v);
+    if(ret == MINI_PARSE_OK)
+        mini_move(v, &b.root);
+    mini_builder_free(&b);
+    return ret;
+}
+
+static void test_parse_push() {
+    static const char* const docs[] = {
+        "null", " true ", "false", "0", "-0", "123", "-1.5e+10", "18446744073709551615", "1e-7",
+        "\"\"", "\"Hello\\nWorld\"", "\"\\uD834\\uDD1E \\\\\\\" x\"", "[ ]", "{ }",
+        "[ null , false , true , 123 , \"abc\" , [ 1, [ 2 ] ] ]",
+        "{ \"n\" : null , \"a\" : [ 1, 2 ], \"o\" : { \"1\" : 1, \"key longer than sixteen\" : \"v\" }, \"d\" : 1, \"d\" : 2 }",
+        "", " ", "nul", "truex", "null x", "0123", "[0123]", "1.", "-", "+1", "1e309",
+        "[1,", "[1 2]", "[1,]", "{", "{\"a\"", "{\"a\":", "{\"a\":1", "{\"a\":1,", "{1:1}", "{\"a\":1 \"b\":2}",
+        "\"abc", "\"\\v\"", "\"\x01\"", "\"\\u12\"", "\"\\uD800\"", "[\"a\", nul]", "{\"a\":tru}",
+        "\"\\u12", "\"a\\", "\"a\x01", "\"\\uD800", "\"\\uD800\\u", "\"a\\\"", "[\"a\\", "{\"a\\u1", "{\"a\x01"
+    };
+    static const mini_handler handler = {
+        test_sax_null, test_sax_boolean, test_sax_number, test_sax_string,
+        test_sax_start_object, test_sax_key, test_sax_end_object,
+        test_sax_start_array, test_sax_end_array
+    };
+    static const mini_handler nothing = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+    size_t i, k, n, expect_len, actual_len;
+    char *expect_json, *actual_json;
+    mini_value expect, actual;
+    test_sax_state st;
+    mini_push p;
+
+    /* every cut point gives what mini_parse gives */
+    for(i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+        int ret;
+        mini_init(&expect);
+        ret = mini_parse(&expect, docs[i]);
+        if(ret == MINI_PARSE_OK)
+            mini_generate(&expect, &expect_json, &expect_len);
+        n = strlen(docs[i]);
+        for(k = 0; k <= n; k++) {
+            EXPECT_EQ_INT(ret, test_push_parse(&actual, docs[i], k == 0 ? 1 : k, k == 0 ? 1 : n));
+            if(ret != MINI_PARSE_OK)
+                continue;
+            mini_generate(&actual, &actual_json, &actual_len);
+            EXPECT_TRUE(actual_len == expect_len && memcmp(expect_json, actual_json, actual_len) == 0);
+            free(actual_json);
+            mini_free(&actual);
+        }
+        if(ret == MINI_PARSE_OK)
+            free(expect_json);
+        mini_free(&expect);
+    }
+
+    /* the events match mini_parse_sax, a stop is kept by later feeds */
+    memset(&st, 0, sizeof(st));
+    mini_push_init(&p, &handler, &st);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_push_feed(&p, "{ \"a\" : [ nu", 12));
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_push_feed(&p, "ll, 1", 5));
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_push_feed(&p, "2, \"x\\", 6));
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_push_feed(&p, "ty\" ] }", 7));
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_push_finish(&p));
+    EXPECT_EQ_STRING("{k:a[ni12s:x\ty]3}1", st.trace, st.len);
+    mini_push_free(&p);
+
+    memset(&st, 0, sizeof(st));
+    st.stop_at = 3;
+    mini_push_init(&p, &handler, &st);
+    EXPECT_EQ_INT(MINI_PARSE_STOPPED, mini_push_feed(&p, "[ 1, 2, 3 ]", 11));
+    EXPECT_EQ_INT(MINI_PARSE_STOPPED, mini_push_feed(&p, " ", 1));
+    EXPECT_EQ_INT(MINI_PARSE_STOPPED, mini_push_finish(&p));
+    EXPECT_EQ_STRING("[i1i2", st.trace, st.len);
+    mini_push_free(&p);
+
+    /* mini_builder keeps equal keys as mini_parse does, lookups see the first one */
+    EXPECT_EQ_INT(MINI_PARSE_OK, test_push_parse(&actual, "{\"a\":1,\"b\":2,\"a\":3}", 5, 5));
+    EXPECT_EQ_SIZE_T(3, mini_get_object_size(&actual));
+    EXPECT_EQ_DOUBLE(1.0, mini_get_number(mini_get_object_value(&actual, "a")));
+    EXPECT_EQ_DOUBLE(3.0, mini_get_number(mini_get_object_value_at(&actual, 2)));
+    mini_free(&actual);
+    EXPECT_EQ_INT(MINI_PARSE_OK, test_push_parse(&actual,
+        "{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5,\"f\":6,\"g\":7,\"h\":8,\"i\":9,"
+        "\"j\":10,\"k\":11,\"l\":12,\"m\":13,\"n\":14,\"o\":15,\"p\":16,\"q\":17,\"a\":18}", 7, 7));
+    EXPECT_EQ_SIZE_T(18, mini_get_object_size(&actual));
+    EXPECT_EQ_DOUBLE(1.0, mini_get_number(mini_get_object_value(&actual, "a")));
+    EXPECT_EQ_DOUBLE(17.0, mini_get_number(mini_get_object_value(&actual, "q")));
+    mini_free(&actual);
+
+    /* nesting is bounded by MINI_PARSE_MAX_DEPTH, as in mini_parse */
+    mini_push_init(&p, &nothing, NULL);
+    for(i = 0; i < MINI_PARSE_MAX_DEPTH; i++)
+        mini_push_feed(&p, "[", 1);
+    for(i = 0; i < MINI_PARSE_MAX_DEPTH; i++)
+        mini_push_feed(&p, "]", 1);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_push_finish(&p));
+    mini_push_free(&p);
+    mini_push_init(&p, &nothing, NULL);
+    for(i = 0; i < MINI_PARSE_MAX_DEPTH; i++)
+        mini_push_feed(&p, "[", 1);
+    EXPECT_EQ_INT(MINI_PARSE_TOO_DEEP, mini_push_feed(&p, "[", 1));
+    EXPECT_EQ_INT(MINI_PARSE_TOO_DEEP, mini_push_finish(&p));
+    mini_push_free(&p);
+}
+
+static void test_parse_document() {
+    mini_document doc;
+    mini_value* root, *a;
+    char* json;
+    size_t length;
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse_document(&doc,
+                "{ \"s\" : \"abc\", \"a\" : [ 1, \"x\", { \"k\" : null } ], \"o\" : { }, \"t\" : true }"));
+    root = mini_document_root(&doc);
+    EXPECT_EQ_INT(MINI_OBJECT, mini_get_type(root));
+    EXPECT_EQ_SIZE_T(4, mini_get_object_size(root));
+    EXPECT_EQ_STRING("abc", mini_get_string(mini_get_object_value(root, "s")), mini_get_string_length(mini_get_object_value(root, "s")));
+    a = mini_get_object_value(root, "a");
+    EXPECT_EQ_SIZE_T(3, mini_get_array_size(a));
+    EXPECT_EQ_DOUBLE(1.0, mini_get_number(mini_get_array_element(a, 0)));
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(mini_get_object_value(mini_get_array_element(a, 2), "k")));
+    mini_generate(root, &json, &length);
+    EXPECT_EQ_STRING("{\"s\":\"abc\",\"a\":[1,\"x\",{\"k\":null}],\"o\":{},\"t\":true}", json, length);
+    free(json);
+    mini_free_document(&doc);
+
+    EXPECT_EQ_INT(MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET, mini_parse_document(&doc, "[ \"a\", { \"b\" : [ 1 ] "));
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(mini_document_root(&doc)));
+    mini_free_document(&doc);
+    EXPECT_EQ_INT(MINI_PARSE_ROOT_NOT_SINGULAR, mini_parse_document(&doc, "{ \"b\" : \"c\" } x"));
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(mini_document_root(&doc)));
+    mini_free_document(&doc);
+}
+
+static void test_parse_document_insitu() {
+    static const char text[] = "{ \"s\" : \"abc\", \"a key longer than sixteen\" : [ \"x\\ty\\u20AC\", \"\" ], \"e\\n\" : \"\\\"q\\\"\" }";
+    char* json = (char*)malloc(sizeof(text));
+    mini_document doc;
+    mini_value* root, *a;
+    char* out;
+    size_t length;
+    memcpy(json, text, sizeof(text));
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse_document_insitu(&doc, json, sizeof(text) - 1));
+    root = mini_document_root(&doc);
+    EXPECT_EQ_SIZE_T(3, mini_get_object_size(root));
+    a = mini_get_object_value(root, "a key longer than sixteen");
+    EXPECT_EQ_STRING("x\ty\xE2\x82\xAC", mini_get_string(mini_get_array_element(a, 0)), mini_get_string_length(mini_get_array_element(a, 0)));
+    EXPECT_EQ_STRING("\"q\"", mini_get_string(mini_get_object_value(root, "e\n")), mini_get_string_length(mini_get_object_value(root, "e\n")));
+    /* strings and long keys live in the text */
+    EXPECT_TRUE(mini_get_string(mini_get_object_value(root, "s")) == json + 9);
+    EXPECT_TRUE(mini_get_object_key(root, 1) == json + 16);
+    EXPECT_TRUE(mini_get_string(mini_get_array_element(a, 0)) == json + 48);
+    mini_generate(root, &out, &length);
+    EXPECT_EQ_STRING("{\"s\":\"abc\",\"a key longer than sixteen\":[\"x\\ty\xE2\x82\xAC\",\"\"],\"e\\n\":\"\\\"q\\\"\"}", out, length);
+    free(out);
+    mini_free_document(&doc);
+
+    memcpy(json, text, sizeof(text));
+    EXPECT_EQ_INT(MINI_PARSE_MISS_COMMA_OR_CURLY_BRACKET, mini_parse_document_insitu(&doc, json, sizeof(text) - 3));
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(mini_document_root(&doc)));
+    mini_free_document(&doc);
+    free(json);
+}
+
+static void test_parse_lazy() {
+    static const char json[] = " { \"id\" : 7, \"s\" : \"a\\\"]}b\", \"deep\" : [ [ { \"k\" : \"[{\" } ], 1.5, null ], \"o\" : { \"t\" : true }, \"e\" : [ ] } ";
+    mini_document doc, full;
+    mini_value* root, *deep;
+    char* out, *expect;
+    size_t length, expect_len;
+
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse_lazy(&doc, json));
+    root = mini_document_root(&doc);
+    EXPECT_EQ_INT(MINI_OBJECT, mini_get_type(root));
+    EXPECT_EQ_SIZE_T(5, mini_get_object_size(root));
+    /* members are built when they are first returned */
+    EXPECT_TRUE(root->u.o.m[2].v.type != MINI_ARRAY);
+    deep = mini_get_object_value(root, "deep");
+    EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(deep));
+    EXPECT_EQ_SIZE_T(3, mini_get_array_size(deep));
+    EXPECT_TRUE(deep->u.a.e[0].type != MINI_ARRAY);
+    EXPECT_EQ_DOUBLE(1.5, mini_get_number(mini_get_array_element(deep, 1)));
+    EXPECT_EQ_STRING("[{", mini_get_string(mini_get_object_value(mini_get_array_element(mini_get_array_element(deep, 0), 0), "k")), 2);
+    EXPECT_EQ_STRING("a\"]}b", mini_get_string(mini_get_object_value(root, "s")), mini_get_string_length(mini_get_object_value(root, "s")));
+    EXPECT_TRUE(root->u.o.m[3].v.type != MINI_OBJECT);
+
+    /* generating builds the rest */
+    mini_generate(root, &out, &length);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse_document(&full, json));
+    mini_generate(mini_document_root(&full), &expect, &expect_len);
+    EXPECT_TRUE(length == expect_len && memcmp(out, expect, length) == 0);
+    free(out);
+    free(expect);
+    mini_free_document(&full);
+    mini_free_document(&doc);
+
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse_lazy_len(&doc, "[\"x\", 12]xyz", 9));
+    EXPECT_EQ_INT(12, (int)mini_get_int64(mini_get_array_element(mini_document_root(&doc), 1)));
+    mini_free_document(&doc);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse_lazy(&doc, " \"text\" "));
+    EXPECT_EQ_STRING("text", mini_get_string(mini_document_root(&doc)), mini_get_string_length(mini_document_root(&doc)));
+    mini_free_document(&doc);
+
+    /* errors deep inside are found up front */
+    EXPECT_EQ_INT(MINI_PARSE_INVALID_VALUE, mini_parse_lazy(&doc, "{ \"a\" : 1, \"b\" : [ [ [ tru ] ] ] }"));
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(mini_document_root(&doc)));
+    mini_free_document(&doc);
+}
+
+/* mini_parse_indexed must agree with mini_parse_len on the code and the value */
+static void test_indexed_compare(const char* json, size_t len) {
+    mini_value expect, actual;
+    int ret;
+    mini_init(&expect);
+    mini_init(&actual);
+    ret = mini_parse_len(&expect, json, len);
+    EXPECT_EQ_INT(ret, mini_parse_indexed(&actual, json, len));
+    if(ret == MINI_PARSE_OK) {
+        char *expect_json, *actual_json;
+        size_t expect_len, actual_len;
+        mini_generate(&expect, &expect_json, &expect_len);
+        mini_generate(&actual, &actual_json, &actual_len);
+        EXPECT_TRUE(actual_len == expect_len && memcmp(expect_json, actual_json, actual_len) == 0);
+        free(expect_json);
+        free(actual_json);
+    }
+    mini_free(&expect);
+    mini_free(&actual);
+}
+
+static void test_parse_indexed() {
+    static const mini_handler handler = {
+        test_sax_null, test_sax_boolean, test_sax_number, test_sax_string,
+        test_sax_start_object, test_sax_key, test_sax_end_object,
+        test_sax_start_array, test_sax_end_array
+    };
+    static const char base[] =
+        "{ \"name\" : \"mini\\\\json\", \"tags\" : [ \"a\\\"b\", \"\\\\\\\"\", \"{[:,]}\" ],\r\n"
+        "\t\"n\" : [ -1.5e+10, 0, 18446744073709551616, true, false, null ],\n"
+        "  \"o\" : { \"k\\u00e9y\" : { }, \"e\" : [ ], \"x\" : \"\\uD834\\uDD1E\" } }  ";
+    static const char small[] = " [ 1 , \"x\" , { \"k\" : null } ] ";
+    static const char alphabet[] = "\"\\ {}[]:,0-e.tx\t\n\x01";
+    const size_t n = sizeof(base) - 1;
+    unsigned long long x = 88172645463325252ULL;
+    char json[sizeof(base)], *s;
+    size_t i, k, run;
+    test_sax_state st;
+
+    /* every prefix, and random bytes replaced with ones that matter to either stage */
+    for(k = 0; k <= n; k++)
+        test_indexed_compare(base, k);
+    for(i = 0; i < 20000; i++) {
+        memcpy(json, base, n);
+        for(k = 0; k <= i % 3; k++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            json[x % n] = alphabet[(x >> 32) % (sizeof(alphabet) - 1)];
+        }
+        test_indexed_compare(json, n);
+    }
+
+    /* backslash runs of every length ending on both sides of a 64-byte block border */
+    s = (char*)malloc(256);
+    for(run = 1; run <= 70; run++) {
+        for(k = 50; k < 70; k++) {
+            memset(s, ' ', k);
+            s[0] = '[';
+            s[k] = '\"';
+            memset(s + k + 1, '\\', run);
+            strcpy(s + k + 1 + run, "\" , \"]\" ]");
+            test_indexed_compare(s, strlen(s));
+        }
+    }
+    free(s);
+
+    /* an escape or a control character at every offset of a string crossing block borders */
+    s = (char*)malloc(256);
+    for(k = 1; k < 140; k++) {
+        memset(s, 'a', 142);
+        s[0] = s[141] = '\"';
+        s[142] = '\0';
+        s[k] = '\t';
+        test_indexed_compare(s, 142);
+        s[k] = '\\';
+        s[k + 1] = k % 2 ? 'n' : '\"';
+        test_indexed_compare(s, 142);
+    }
+    free(s);
+
+    /* every byte structural: the offsets fill the index up to its sentinel */
+    s = (char*)malloc(1024);
+    for(k = 512; k <= 1024; k += 512) {
+        memset(s, ',', k);
+        test_indexed_compare(s, k);
+        memset(s, '[', k / 2);
+        memset(s + k / 2, ']', k / 2);
+        test_indexed_compare(s, k);
+    }
+    free(s);
+
+    memset(&st, 0, sizeof(st));
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse_sax_indexed(small, sizeof(small) - 1, &handler, &st));
+    EXPECT_EQ_STRING("[i1s:x{k:kn}1]3", st.trace, st.len);
+    memset(&st, 0, sizeof(st));
+    EXPECT_EQ_INT(MINI_PARSE_ROOT_NOT_SINGULAR, mini_parse_sax_indexed("1x", 2, &handler, &st));
+    EXPECT_EQ_INT(MINI_PARSE_EXPECT_VALUE, mini_parse_sax_indexed(NULL, 0, &handler, &st));
+}
+
+static void test_parse() {
+    test_parse_null();
+    test_parse_true();
+    test_parse_false();
+    test_parse_number();
+    test_parse_number_exact();
+    test_parse_string();
+    test_parse_expect_value();
+    test_parse_invalid_value();
+    test_parse_root_not_singular();
+    test_parse_number_too_big();
+    test_parse_missing_quotation_mark();
+    test_parse_invalid_string_escape();
+    test_parse_invalid_string_char();
+    test_parse_invalid_unicode_hex();
+    test_parse_invalid_unicode_surrogate();
+    test_parse_array();
+    test_parse_object();
+    test_parse_miss_comma_or_square_bracket();
+    test_parse_miss_key();
+    test_parse_miss_colon();
+    test_parse_miss_comma_or_curly_bracket();
+    test_parse_too_deep();
+    test_parse_scan();
+    test_parse_document();
+    test_parse_document_insitu();
+    test_parse_lazy();
+    test_parse_sax();
+    test_parse_len();
+    test_parse_push();
+    test_parse_indexed();
+}
+
+#define TEST_ROUNDTRIP(json)\
+        do {\
+                    mini_value v;\
+                    char* json2;\
+                    size_t length;\
+                    mini_init(&v);\
+                    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, json));\
+                    mini_generate(&v, &json2, &length);\
+                    EXPECT_EQ_STRING(json, json2, length);\
+                    mini_free(&v);\
+                    free(json2);\
+                } while(0)
+
+#define TEST_GENERATE(value, json)\
+        do {\
+                    char* json2;\
+                    size_t length;\
+                    mini_generate(value, &json2, &length);\
+                    EXPECT_EQ_STRING(json, json2, length);\
+                    free(json2);\
+                } while(0)
+
+static void test_creater_number() {
+    TEST_ROUNDTRIP("0");
+    TEST_ROUNDTRIP("-0");
+    TEST_ROUNDTRIP("1");
+    TEST_ROUNDTRIP("-1");
+    TEST_ROUNDTRIP("1.5");
+    TEST_ROUNDTRIP("-1.5");
+    TEST_ROUNDTRIP("3.25");
+    TEST_ROUNDTRIP("1e+20");
+    TEST_ROUNDTRIP("1.234e+20");
+    TEST_ROUNDTRIP("1.234e-20");
+    TEST_ROUNDTRIP("1.0000000000000002"); /* the smallest number > 1 */
+    TEST_ROUNDTRIP("5e-324"); /* minimum denormal */
+    TEST_ROUNDTRIP("-5e-324");
+    TEST_ROUNDTRIP("2.225073858507201e-308");  /* Max subnormal double */
+    TEST_ROUNDTRIP("-2.225073858507201e-308");
+    TEST_ROUNDTRIP("2.2250738585072014e-308");  /* Min normal positive double */
+    TEST_ROUNDTRIP("-2.2250738585072014e-308");
+    TEST_ROUNDTRIP("1.7976931348623157e+308");  /* Max double */
+    TEST_ROUNDTRIP("-1.7976931348623157e+308");
+    TEST_ROUNDTRIP("0.1");  /* shortest digits, not 0.10000000000000001 */
+    TEST_ROUNDTRIP("0.30000000000000004");
+    TEST_ROUNDTRIP("0.0001");
+    TEST_ROUNDTRIP("1e-05");
+    TEST_ROUNDTRIP("12345.678");
+    TEST_ROUNDTRIP("1e+17");
+    TEST_ROUNDTRIP("1.5e+300");
+    TEST_ROUNDTRIP("9007199254740993");  /* 2^53 + 1 stays exact */
+    TEST_ROUNDTRIP("9223372036854775807");
+    TEST_ROUNDTRIP("-9223372036854775808");
+    TEST_ROUNDTRIP("18446744073709551615");
+}
+
+/* json has no NaN or infinity, they are generated as null */
+static void test_creater_number_nonfinite() {
+    mini_value arr, e;
+    mini_init_array(&arr);
+    mini_init(&e);
+    mini_set_number(&e, NAN);
+    mini_add_value_to_array(&arr, &e);
+    mini_set_number(&e, INFINITY);
+    mini_add_value_to_array(&arr, &e);
+    mini_set_number(&e, -INFINITY);
+    mini_add_value_to_array(&arr, &e);
+    TEST_GENERATE(&arr, "[null,null,null]");
+    TEST_GENERATE(&e, "null");
+    mini_free(&arr);
+}
+
+static void test_creater_string() {
+    TEST_ROUNDTRIP("\"\"");
+    TEST_ROUNDTRIP("\"Hello\"");
+    TEST_ROUNDTRIP("\"Hello\\nWorld\"");
+    TEST_ROUNDTRIP("\"\\\" \\\\ / \\b \\f \\n \\r \\t\"");
+    TEST_ROUNDTRIP("\"Hello\\u0000World\"");
+}
+
+static void test_creater_array() {
+    TEST_ROUNDTRIP("[]");
+    TEST_ROUNDTRIP("[null,false,true,123,\"abc\",[1,2,3]]");
+}
+
+static void test_creater_object() {
+    TEST_ROUNDTRIP("{}");
+    TEST_ROUNDTRIP("{\"a\\u0000b\":1,\"\":2}");
+    TEST_ROUNDTRIP("{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3}}");
+    TEST_ROUNDTRIP("{\"a\":[1,2,3],\"f\":false,\"i\":123,\"n\":null,\"o\":{\"1\":1,\"2\":2,\"3\":3},\"s\":\"abc\",\"t\":true}");
+}
+
+/* generated doubles must read back bit for bit */
+static void test_creater_number_exact() {
+    unsigned long long x = 88172645463325252ULL;
+    int i, mismatches = 0;
+    mini_value v, v2;
+    char* json;
+    mini_init(&v);
+    mini_init(&v2);
+    for(i = 0; i < 100000; i++) {
+        double d;
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        memcpy(&d, &x, sizeof(d));
+        if(d != d || d - d != 0) continue;
+        mini_set_number(&v, d);
+        mini_generate(&v, &json, NULL);
+        if(mini_parse(&v2, json) != MINI_PARSE_OK || mini_get_number(&v2) != d)
+            mismatches++;
+        free(json);
+    }
+    EXPECT_EQ_INT(0, mismatches);
+}
+
+typedef struct {
+    char* buf;
+    size_t len, calls, largest, fail_at;
+}test_sink_state;
+
+static int test_sink(void* user, const char* data, size_t len) {
+    test_sink_state* st = (test_sink_state*)user;
+    st->calls++;
+    if(st->calls == st->fail_at)
+        return -1;
+    st->buf = (char*)realloc(st->buf, st->len + len);
+    memcpy(st->buf + st->len, data, len);
+    st->len += len;
+    if(len > st->largest)
+        st->largest = len;
+    return 0;
+}
+
+static void test_creater_sink() {
+    test_sink_state st;
+    mini_value v, e;
+    char* json, *big;
+    size_t length, i;
+    mini_init(&v);
+    mini_init(&e);
+    mini_init_array(&v);
+    for(i = 0; i < 20000; i++) {
+        mini_set_number(&e, i * 0.5);
+        mini_add_value_to_array(&v, &e);
+    }
+    /* a string far longer than a chunk, with characters that need escaping */
+    big = (char*)malloc(100000);
+    for(i = 0; i < 100000; i++)
+        big[i] = i % 100 == 0 ? '\n' : (char)('a' + i % 26);
+    mini_set_string(&e, big, 100000);
+    mini_add_value_to_array(&v, &e);
+    free(big);
+
+    memset(&st, 0, sizeof(st));
+    EXPECT_EQ_INT(MINI_GENERATE_OK, mini_generate_to(&v, test_sink, &st));
+    mini_generate(&v, &json, &length);
+    EXPECT_EQ_SIZE_T(length, st.len);
+    EXPECT_TRUE(memcmp(json, st.buf, length) == 0);
+    EXPECT_TRUE(st.calls > 10);
+    EXPECT_TRUE(st.largest < 8 * 4096);
+    free(json);
+    free(st.buf);
+
+    /* a failing sink stops the generator and is not called again */
+    memset(&st, 0, sizeof(st));
+    st.fail_at = 3;
+    EXPECT_EQ_INT(MINI_GENERATE_SINK_ERROR, mini_generate_to(&v, test_sink, &st));
+    EXPECT_EQ_SIZE_T(3, st.calls);
+    free(st.buf);
+    mini_free(&e);
+    mini_free(&v);
+}
+
+static void test_creater_file() {
+    static const char json[] = "{\"a\":[1,2.5,\"x\\ny\"],\"key longer than sixteen\":{\"t\":true,\"n\":null}}";
+    char path[] = "/tmp/mini_json_XXXXXX";
+    mini_document doc;
+    mini_value v, w;
+    char* out;
+    size_t length;
+    int fd = mkstemp(path);
+    EXPECT_TRUE(fd >= 0);
+    close(fd);
+
+    /* through a descriptor, then read back from the mapped file */
+    mini_init(&v);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, json));
+    EXPECT_EQ_INT(MINI_GENERATE_OK, mini_generate_file(&v, path));
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse_file(&w, path));
+    mini_generate(&w, &out, &length);
+    EXPECT_EQ_STRING(json, out, length);
+    free(out);
+    mini_free(&w);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse_document_file(&doc, path));
+    mini_generate(mini_document_root(&doc), &out, &length);
+    EXPECT_EQ_STRING(json, out, length);
+    free(out);
+    mini_free_document(&doc);
+
+    fd = open(path, O_WRONLY | O_TRUNC);
+    EXPECT_EQ_INT(MINI_GENERATE_OK, mini_generate_to(&v, mini_fd_sink, &fd));
+    EXPECT_EQ_INT(MINI_GENERATE_OK, mini_generate_to(&v, mini_fd_sink, &fd));
+    close(fd);
+    EXPECT_EQ_INT(MINI_PARSE_ROOT_NOT_SINGULAR, mini_parse_file(&w, path));
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(&w));
+
+    /* an empty file holds no value, a missing one is an error of its own */
+    fd = open(path, O_WRONLY | O_TRUNC);
+    close(fd);
+    EXPECT_EQ_INT(MINI_PARSE_EXPECT_VALUE, mini_parse_file(&w, path));
+    unlink(path);
+    EXPECT_EQ_INT(MINI_PARSE_FILE_ERROR, mini_parse_file(&w, path));
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(&w));
+    EXPECT_EQ_INT(MINI_PARSE_FILE_ERROR, mini_parse_document_file(&doc, path));
+    mini_free_document(&doc);
+    EXPECT_EQ_INT(MINI_GENERATE_SINK_ERROR, mini_generate_file(&v, "/nonexistent-dir/x.json"));
+    mini_free(&v);
+}
+
+static void test_creater() {
+#if 1
+    TEST_ROUNDTRIP("null");
+    TEST_ROUNDTRIP("false");
+    TEST_ROUNDTRIP("true");
+    test_creater_number();
+    test_creater_number_exact();
+    test_creater_number_nonfinite();
+    test_creater_string();
+    test_creater_array();
+#endif
+    test_creater_object();
+    test_creater_sink();
+    test_creater_file();
+}
+
+static void test_access_null() {
+    mini_value v;
+    mini_init(&v);
+    mini_set_string(&v, "a", 1);
+    mini_set_null(&v);
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(&v));
+    mini_free(&v);
+}
+
+static void test_access_boolean() {
+    mini_value v;
+    mini_init(&v);
+    mini_set_string(&v, "a", 1);
+    mini_set_boolean(&v, 1);
+    EXPECT_TRUE(mini_get_boolean(&v));
+    mini_set_boolean(&v, 0);
+    EXPECT_FALSE(mini_get_boolean(&v));
+    mini_free(&v);
+}
+
+static void test_access_number() {
+    mini_value v;
+    mini_init(&v);
+    mini_set_string(&v, "a", 1);
+    mini_set_number(&v, 1234.5);
+    EXPECT_EQ_DOUBLE(1234.5, mini_get_number(&v));
+    EXPECT_EQ_INT(MINI_NUMBER_DOUBLE, mini_get_number_kind(&v));
+    mini_set_int64(&v, INT64_MIN);
+    EXPECT_EQ_INT(MINI_NUMBER_INT64, mini_get_number_kind(&v));
+    EXPECT_TRUE(mini_get_int64(&v) == INT64_MIN);
+    mini_set_uint64(&v, UINT64_MAX);
+    EXPECT_EQ_INT(MINI_NUMBER_UINT64, mini_get_number_kind(&v));
+    EXPECT_TRUE(mini_get_uint64(&v) == UINT64_MAX);
+    mini_free(&v);
+}
+
+#define TEST_INTEGER(kind, json)\
+    do {\
+        EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, json));\
+        EXPECT_EQ_INT(MINI_NUMBER, mini_get_type(&v));\
+        EXPECT_EQ_INT(kind, mini_get_number_kind(&v));\
+    } while(0)
+
+static void test_access_integer() {
+    mini_value v;
+    mini_init(&v);
+    TEST_INTEGER(MINI_NUMBER_INT64, "0");
+    EXPECT_TRUE(mini_get_int64(&v) == 0);
+    TEST_INTEGER(MINI_NUMBER_DOUBLE, "-0");
+    TEST_INTEGER(MINI_NUMBER_DOUBLE, "1.0");
+    TEST_INTEGER(MINI_NUMBER_DOUBLE, "1e2");
+    TEST_INTEGER(MINI_NUMBER_INT64, "1234567890123456789");
+    EXPECT_TRUE(mini_get_int64(&v) == 1234567890123456789LL);
+    EXPECT_TRUE(mini_get_uint64(&v) == 1234567890123456789ULL);
+    TEST_INTEGER(MINI_NUMBER_INT64, "-9223372036854775808");
+    EXPECT_TRUE(mini_get_int64(&v) == INT64_MIN);
+    TEST_INTEGER(MINI_NUMBER_DOUBLE, "-9223372036854775809");
+    EXPECT_EQ_DOUBLE(-9223372036854775808.0, mini_get_number(&v));
+    TEST_INTEGER(MINI_NUMBER_UINT64, "9223372036854775808");
+    EXPECT_TRUE(mini_get_uint64(&v) == 9223372036854775808ULL);
+    TEST_INTEGER(MINI_NUMBER_UINT64, "10000000000000000000");
+    EXPECT_TRUE(mini_get_uint64(&v) == 10000000000000000000ULL);
+    TEST_INTEGER(MINI_NUMBER_UINT64, "18446744073709551615");
+    EXPECT_TRUE(mini_get_uint64(&v) == UINT64_MAX);
+    EXPECT_EQ_DOUBLE(18446744073709551615.0, mini_get_number(&v));
+    TEST_INTEGER(MINI_NUMBER_DOUBLE, "18446744073709551616");
+    EXPECT_EQ_DOUBLE(18446744073709551616.0, mini_get_number(&v));
+    TEST_INTEGER(MINI_NUMBER_DOUBLE, "100000000000000000000");
+    mini_free(&v);
+}
+
+static void test_access_string() {
+    mini_value v;
+    mini_init(&v);
+    mini_set_string(&v, "", 0);
+    EXPECT_EQ_STRING("", mini_get_string(&v), mini_get_string_length(&v));
+    mini_set_string(&v, "Hello", 5);
+    EXPECT_EQ_STRING("Hello", mini_get_string(&v), mini_get_string_length(&v));
+    mini_free(&v);
+}
+
+static void test_access() {
+    test_access_null();
+    test_access_boolean();
+    test_access_number();
+    test_access_integer();
+    test_access_string();
+}
+
+static void test_add_value_to_array() {
+    mini_value arr, v;
+    mini_init_array(&arr);
+    EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(&arr));
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&arr, "[ null,false,true,\"ab\" ]"));
+    EXPECT_EQ_SIZE_T(4, mini_get_array_size(&arr));
+    
+    mini_init(&v);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "\"abc\""));
+    EXPECT_EQ_INT(MINI_STRING, mini_get_type(&v));
+    mini_add_value_to_array(&arr, &v);
+    EXPECT_EQ_SIZE_T(5, mini_get_array_size(&arr));
+    mini_free(&v);
+
+    mini_init(&v);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "[ \"a\", \"b\" ]"));
+    EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(&v));
+    mini_add_value_to_array(&arr, &v);
+    EXPECT_EQ_SIZE_T(6, mini_get_array_size(&arr));
+    mini_free(&v);
+    
+    mini_init(&v);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "{ \"object\" : [ 4, 5, \"6\" ] }"));
+    EXPECT_EQ_INT(MINI_OBJECT, mini_get_type(&v));
+    mini_add_value_to_array(&arr, &v);
+    EXPECT_EQ_SIZE_T(7, mini_get_array_size(&arr));
+    mini_free(&v);
+
+    //mini_show_value(&arr);
+    mini_free(&arr);
+
+    /* the appended value lives in the array that grows */
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&arr, "[[1,2,3,4],1,2,3]"));
+    mini_add_value_to_array(&arr, mini_get_array_element(&arr, 0));
+    mini_add_value_to_array(&arr, mini_get_array_element(mini_get_array_element(&arr, 0), 3));
+    mini_move_value_to_array(&arr, mini_get_array_element(&arr, 4));
+    EXPECT_EQ_SIZE_T(7, mini_get_array_size(&arr));
+    TEST_GENERATE(&arr, "[[1,2,3,4],1,2,3,null,4,[1,2,3,4]]");
+    mini_free(&arr);
+}
+
+static void test_add_value_to_object() {
+    mini_value obj, key, val;
+    //mini_init_object(&obj);
+    //EXPECT_EQ_INT(MINI_OBJECT, mini_get_type(&obj));
+
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&obj, "{ \"a\" : \"apple\" }"));
+    EXPECT_EQ_SIZE_T(1, mini_get_object_size(&obj));
+
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&key, "\"c\""));
+    EXPECT_EQ_INT(MINI_STRING, mini_get_type(&key));
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&val, "[ \"cat\", 2 ]"));
+    EXPECT_EQ_SIZE_T(2, mini_get_array_size(&val));
+    mini_add_value_to_object(&obj, &key, &val);
+    EXPECT_EQ_SIZE_T(2, mini_get_object_size(&obj));
+    mini_free(&key);
+    mini_free(&val);
+
+    //mini_show_value(&obj);
+    mini_free(&obj);
+
+    /* the key and the value live in the object that changes */
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&obj, "{\"a\":[[1,2],\"b\"],\"k\":\"a-rather-long-key\"}"));
+    mini_add_value_to_object(&obj, mini_get_object_value(&obj, "k"), mini_get_object_value(&obj, "a"));
+    mini_add_value_to_object(&obj, mini_get_array_element(mini_get_object_value(&obj, "a"), 1), mini_get_object_value(&obj, "a"));
+    val = *mini_get_object_value(&obj, "b");
+    mini_add_value_to_object(&obj, mini_get_array_element(&val, 1), mini_get_array_element(&val, 0));
+    EXPECT_EQ_SIZE_T(5, mini_get_object_size(&obj));
+    TEST_GENERATE(&obj, "{\"a\":[[1,2],\"b\"],\"k\":\"a-rather-long-key\",\"a-rather-long-key\":[[1,2],\"b\"],"
+        "\"b\":[[1,2],\"b\"],\"b\":[1,2]}");
+    /* an equal key is appended, lookups see the first one */
+    EXPECT_EQ_SIZE_T(2, mini_get_array_size(mini_get_object_value(&obj, "b")));
+    EXPECT_EQ_SIZE_T(3, mini_find_object_index(&obj, "b", 1));
+    mini_free(&obj);
+}
+
+static void test_copy() {
+    mini_value v1, v2;
+    mini_value* pv;
+    char *json1, *json2;
+    size_t len1, len2;
+    mini_init(&v1);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v1, "{\"t\":true,\"f\":false,\"n\":null,\"d\":1.5,\"a\":[1,2,\"x\\u0000y\"],\"o\":{\"k\":{}}}"));
+    mini_init(&v2);
+    mini_copy(&v2, &v1);
+    mini_generate(&v1, &json1, &len1);
+    mini_generate(&v2, &json2, &len2);
+    EXPECT_EQ_SIZE_T(len1, len2);
+    EXPECT_TRUE(memcmp(json1, json2, len1) == 0);
+    EXPECT_EQ_SIZE_T(6, mini_get_object_size(&v2));
+    EXPECT_EQ_SIZE_T(3, mini_get_string_length(mini_get_array_element(mini_get_object_value(&v2, "a"), 2)));
+    EXPECT_TRUE(mini_get_object_value(&v1, "a") != mini_get_object_value(&v2, "a"));
+    free(json1);
+    free(json2);
+
+    pv = mini_backup(&v1);
+    mini_free(&v1);
+    EXPECT_EQ_INT(MINI_OBJECT, mini_get_type(pv));
+    EXPECT_EQ_DOUBLE(1.5, mini_get_number(mini_get_object_value(pv, "d")));
+    mini_free(pv);
+    free(pv);
+    mini_free(&v2);
+}
+
+static void test_move_value() {
+    mini_value arr, obj, key, v;
+    const char* s;
+
+    mini_init(&arr);
+    mini_init_array(&arr);
+    mini_init(&v);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, "[ 1, \"two\" ]"));
+    mini_move_value_to_array(&arr, &v);
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(&v));
+    EXPECT_EQ_SIZE_T(1, mini_get_array_size(&arr));
+    EXPECT_EQ_SIZE_T(2, mini_get_array_size(mini_get_array_element(&arr, 0)));
+
+    mini_init(&obj);
+    mini_init_object(&obj);
+    mini_init(&key);
+    mini_set_string(&key, "a-rather-long-list-key", 22);
+    s = mini_get_string(&key);
+    mini_move_value_to_object(&obj, &key, &arr);
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(&key));
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(&arr));
+    EXPECT_EQ_SIZE_T(1, mini_get_object_size(&obj));
+    EXPECT_TRUE(mini_get_object_key(&obj, 0) == s); /* long keys are stolen, not copied */
+    EXPECT_EQ_INT(MINI_ARRAY, mini_get_type(mini_get_object_value(&obj, "a-rather-long-list-key")));
+
+    mini_move(&v, &obj);
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(&obj));
+    EXPECT_EQ_SIZE_T(1, mini_get_object_size(&v));
+    mini_free(&v);
+
+    /* the key and the value live in the object that changes */
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&obj, "{\"a\":[[1,2],\"a-rather-long-key\",[3],\"a\"]}"));
+    v = *mini_get_object_value(&obj, "a");
+    mini_move_value_to_object(&obj, mini_get_array_element(&v, 1), mini_get_array_element(&v, 0));
+    EXPECT_EQ_SIZE_T(2, mini_get_object_size(&obj));
+    TEST_GENERATE(&obj, "{\"a\":[null,null,[3],\"a\"],\"a-rather-long-key\":[1,2]}");
+    mini_move_value_to_object(&obj, mini_get_array_element(&v, 3), mini_get_array_element(&v, 2));
+    EXPECT_EQ_SIZE_T(3, mini_get_object_size(&obj));
+    TEST_GENERATE(&obj, "{\"a\":[null,null,null,null],\"a-rather-long-key\":[1,2],\"a\":[3]}");
+    EXPECT_EQ_SIZE_T(0, mini_find_object_index(&obj, "a", 1));
+    mini_free(&obj);
+}
+
+static void test_array_capacity() {
+    mini_value arr, e;
+    size_t i;
+    mini_init(&arr);
+    mini_init_array(&arr);
+    EXPECT_EQ_SIZE_T(0, mini_get_array_capacity(&arr));
+    mini_reserve_array(&arr, 5);
+    EXPECT_EQ_SIZE_T(5, mini_get_array_capacity(&arr));
+    EXPECT_EQ_SIZE_T(0, mini_get_array_size(&arr));
+    mini_init(&e);
+    for(i = 0; i < 100; i++) {
+        mini_set_number(&e, (double)i);
+        mini_add_value_to_array(&arr, &e);
+    }
+    EXPECT_EQ_SIZE_T(100, mini_get_array_size(&arr));
+    EXPECT_TRUE(mini_get_array_capacity(&arr) >= 100);
+    for(i = 0; i < 100; i++)
+        EXPECT_EQ_DOUBLE((double)i, mini_get_number(mini_get_array_element(&arr, i)));
+    mini_shrink_array(&arr);
+    EXPECT_EQ_SIZE_T(100, mini_get_array_capacity(&arr));
+    EXPECT_EQ_DOUBLE(99.0, mini_get_number(mini_get_array_element(&arr, 99)));
+    mini_free(&arr);
+
+    mini_init_array(&arr);
+    mini_reserve_array(&arr, 8);
+    mini_shrink_array(&arr);
+    EXPECT_EQ_SIZE_T(0, mini_get_array_capacity(&arr));
+    mini_free(&arr);
+}
+
+static void test_object_members() {
+    mini_value obj, key, val, copy;
+    char buf[32];
+    size_t i, n, len;
+    mini_init(&obj);
+    mini_init_object(&obj);
+    mini_init(&key);
+    mini_init(&val);
+    for(i = 0; i < 300; i++) {
+        len = sprintf(buf, i % 2 ? "k%u" : "a-long-member-key-%u", (unsigned)i);
+        mini_set_string(&key, buf, len);
+        mini_set_number(&val, (double)i);
+        mini_add_value_to_object(&obj, &key, &val);
+    }
+    EXPECT_EQ_SIZE_T(300, mini_get_object_size(&obj));
+    EXPECT_TRUE(mini_get_object_capacity(&obj) >= 300);
+    for(i = 0; i < 300; i++) {
+        len = sprintf(buf, i % 2 ? "k%u" : "a-long-member-key-%u", (unsigned)i);
+        EXPECT_TRUE(len == mini_get_object_key_length(&obj, i) && memcmp(buf, mini_get_object_key(&obj, i), len) == 0);
+        EXPECT_EQ_DOUBLE((double)i, mini_get_number(mini_get_object_value(&obj, buf)));
+    }
+    EXPECT_TRUE(mini_get_object_value(&obj, "k2") == NULL);
+
+    /* adding an existing key appends a member, lookups see the first one */
+    mini_set_string(&key, "k1", 2);
+    mini_set_string(&val, "one", 3);
+    mini_add_value_to_object(&obj, &key, &val);
+    EXPECT_EQ_SIZE_T(301, mini_get_object_size(&obj));
+    EXPECT_EQ_DOUBLE(1.0, mini_get_number(mini_get_object_value(&obj, "k1")));
+    EXPECT_EQ_STRING("one", mini_get_string(mini_get_object_value_at(&obj, 300)), 3);
+
+    mini_init(&copy);
+    mini_copy(&copy, &obj);
+    EXPECT_EQ_SIZE_T(301, mini_get_object_size(&copy));
+    EXPECT_EQ_DOUBLE(298.0, mini_get_number(mini_get_object_value(&copy, "a-long-member-key-298")));
+    EXPECT_EQ_DOUBLE(1.0, mini_get_number(mini_get_object_value(&copy, "k1")));
+    EXPECT_EQ_SIZE_T(1, mini_find_object_index(&copy, "k1", 2));
+    mini_free(&copy);
+    mini_free(&key);
+    mini_free(&val);
+    mini_free(&obj);
+
+    /* duplicate keys are kept by the parser, lookups see the first one */
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&obj, "{\"a\":1,\"b\":2,\"a\":3}"));
+    EXPECT_EQ_SIZE_T(3, mini_get_object_size(&obj));
+    EXPECT_EQ_DOUBLE(1.0, mini_get_number(mini_get_object_value(&obj, "a")));
+    EXPECT_EQ_DOUBLE(3.0, mini_get_number(mini_get_object_value_at(&obj, 2)));
+    mini_free(&obj);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&obj,
+        "{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5,\"f\":6,\"g\":7,\"h\":8,\"i\":9,"
+        "\"j\":10,\"k\":11,\"l\":12,\"m\":13,\"n\":14,\"o\":15,\"p\":16,\"q\":17,\"a\":18}"));
+    EXPECT_EQ_SIZE_T(18, mini_get_object_size(&obj));
+    EXPECT_EQ_DOUBLE(1.0, mini_get_number(mini_get_object_value(&obj, "a")));
+    mini_free(&obj);
+
+    /* keys are compared by length, they may hold '\0' and need no terminator */
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&obj, "{\"a\\u0000b\":1,\"a\":2,\"ab\":3,\"\":4}"));
+    EXPECT_EQ_SIZE_T(0, mini_find_object_index(&obj, "a\0b", 3));
+    EXPECT_EQ_SIZE_T(1, mini_find_object_index(&obj, "a\0b", 1));
+    EXPECT_EQ_SIZE_T(2, mini_find_object_index(&obj, "abc", 2));
+    EXPECT_EQ_SIZE_T(3, mini_find_object_index(&obj, "", 0));
+    EXPECT_EQ_SIZE_T(MINI_KEY_NOT_EXIST, mini_find_object_index(&obj, "abc", 3));
+    EXPECT_EQ_DOUBLE(2.0, mini_get_number(mini_find_object_value(&obj, "a\0b", 1)));
+    EXPECT_EQ_SIZE_T(3, mini_get_object_key_length(&obj, 0));
+    EXPECT_TRUE(mini_find_object_value(&obj, "b", 1) == NULL);
+    mini_free(&obj);
+
+    /* keys with and without escapes, inline and allocated */
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&obj, "{\"k\\n\":1,\"a-long-key-with\\ttab\":2,\"a-long-key-without-tab\":3}"));
+    EXPECT_EQ_DOUBLE(1.0, mini_get_number(mini_get_object_value(&obj, "k\n")));
+    EXPECT_EQ_DOUBLE(2.0, mini_get_number(mini_get_object_value(&obj, "a-long-key-with\ttab")));
+    EXPECT_EQ_DOUBLE(3.0, mini_get_number(mini_get_object_value(&obj, "a-long-key-without-tab")));
+    mini_free(&obj);
+
+    /* on both sides of the linear scan limit */
+    for(n = MINI_OBJECT_SCAN_SIZE; n <= MINI_OBJECT_SCAN_SIZE + 1; n++) {
+        char json[512], *p = json;
+        *p++ = '{';
+        for(i = 0; i < n; i++)
+            p += sprintf(p, "%s\"m%u\":%u", i ? "," : "", (unsigned)i, (unsigned)i);
+        strcpy(p, "}");
+        EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&obj, json));
+        EXPECT_EQ_SIZE_T(n, mini_get_object_capacity(&obj));
+        for(i = 0; i < n; i++) {
+            sprintf(buf, "m%u", (unsigned)i);
+            EXPECT_EQ_DOUBLE((double)i, mini_get_number(mini_get_object_value(&obj, buf)));
+        }
+        EXPECT_TRUE(mini_get_object_value(&obj, "m") == NULL);
+        mini_free(&obj);
+    }
+}
+
+static void test_alloc_sizes() {
+    static const size_t sizes[] = { 1, 8, 24, 127, 128, 200, 255, 256, 300, 1000, 4000, 4080, 4081, 10000 };
+    size_t i, j;
+    for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        unsigned char* p = (unsigned char*)lalloc(sizes[i], 1);
+        int zeroed = 1;
+        for(j = 0; j < sizes[i]; j++)
+            zeroed &= p[j] == 0;
+        EXPECT_TRUE(zeroed);
+        EXPECT_TRUE(((size_t)p & 15) == 0);
+        memset(p, 0xAB, sizes[i]);
+        p = (unsigned char*)lrealloc(p, sizes[i] * 3);
+        EXPECT_TRUE(((size_t)p & 15) == 0);
+        EXPECT_TRUE(p[0] == 0xAB && p[sizes[i] - 1] == 0xAB);
+        lfree(p);
+    }
+}
+
+static void test_alloc_trim() {
+    AllocStats s0, s1, s2, s3;
+    void** ps = (void**)malloc(20000 * sizeof(void*));
+    size_t i, free0 = 0, free2 = 0;
+    lalloc_stats(&s0);
+    for(i = 0; i < 20000; i++)
+        ps[i] = lalloc(40, 1);
+    lalloc_stats(&s1);
+    EXPECT_EQ_SIZE_T(s0.in_use + 20000 * 64, s1.in_use);
+    EXPECT_TRUE(s1.reserved >= s1.in_use);
+    for(i = 0; i < 20000; i++)
+        lfree(ps[i]);
+    lalloc_stats(&s2);
+    EXPECT_EQ_SIZE_T(s0.in_use, s2.in_use);
+    for(i = 0; i < NCLASS; i++) {
+        free0 += s0.free_chunks[i];
+        free2 += s2.free_chunks[i];
+    }
+    EXPECT_TRUE(free2 >= 20000 && free2 >= free0);
+    EXPECT_TRUE(lalloc_trim() > 0);
+    lalloc_stats(&s3);
+    EXPECT_TRUE(s3.reserved < s2.reserved);
+    EXPECT_EQ_SIZE_T(s0.in_use, s3.in_use);
+    /* still usable after trimming */
+    ps[0] = lalloc(40, 1);
+    lfree(ps[0]);
+    free(ps);
+}
+
+static void test_long_string() {
+    mini_value v, v2;
+    char* s = (char*)malloc(5001);
+    char* json;
+    size_t length;
+    memset(s, 'x', 5000);
+    s[5000] = '\0';
+    mini_init(&v);
+    mini_set_string(&v, s, 300);
+    EXPECT_EQ_SIZE_T(300, mini_get_string_length(&v));
+    mini_set_string(&v, s, 5000);
+    EXPECT_EQ_SIZE_T(5000, mini_get_string_length(&v));
+    mini_init(&v2);
+    mini_copy(&v2, &v);
+    EXPECT_TRUE(memcmp(s, mini_get_string(&v2), 5001) == 0);
+    mini_generate(&v2, &json, &length);
+    EXPECT_EQ_SIZE_T(5002, length);
+    mini_free(&v);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_parse(&v, json));
+    EXPECT_EQ_SIZE_T(5000, mini_get_string_length(&v));
+    free(json);
+    mini_free(&v);
+    mini_free(&v2);
+    free(s);
+}
+
+#define TEST_THREAD_NUM 8
+#define TEST_THREAD_LOOP 500
+
+typedef struct {
+    mini_value kept;
+    int failed;
+}test_thread_arg;
+
+static void* test_thread_parse_worker(void* p) {
+    test_thread_arg* arg = (test_thread_arg*)p;
+    int i;
+    for(i = 0; i < TEST_THREAD_LOOP; i++) {
+        mini_value v;
+        mini_init(&v);
+        if(mini_parse(&v, "{ \"id\" : 7, \"name\" : \"worker\", \"tags\" : { \"a\" : 1, \"b\" : 2, \"c\" : 3 } }") != MINI_PARSE_OK
+            || mini_get_object_size(&v) != 3
+            || mini_get_number(mini_get_object_value(&v, "id")) != 7.0
+            || mini_get_object_size(mini_get_object_value(&v, "tags")) != 3)
+            arg->failed++;
+        if(i == TEST_THREAD_LOOP - 1)
+            mini_move(&arg->kept, &v); /* freed later by the main thread */
+        mini_free(&v);
+    }
+    return NULL;
+}
+
+static void test_thread_parse() {
+    pthread_t threads[TEST_THREAD_NUM];
+    test_thread_arg args[TEST_THREAD_NUM];
+    int i;
+    for(i = 0; i < TEST_THREAD_NUM; i++) {
+        mini_init(&args[i].kept);
+        args[i].failed = 0;
+        pthread_create(&threads[i], NULL, test_thread_parse_worker, &args[i]);
+    }
+    for(i = 0; i < TEST_THREAD_NUM; i++) {
+        pthread_join(threads[i], NULL);
+        EXPECT_EQ_INT(0, args[i].failed);
+        EXPECT_EQ_INT(MINI_OBJECT, mini_get_type(&args[i].kept));
+        mini_free(&args[i].kept);
+    }
+}
+
+/* values built through the interface have no depth limit, freeing and generating them use no recursion */
+static void test_deep_value() {
+    const size_t depth = 200000;
+    mini_value v, inner;
+    char* json, *copy_json;
+    size_t i, length, copy_length;
+    mini_init(&v);
+    mini_set_number(&v, 1.0);
+    for(i = 0; i < depth; i++) {
+        mini_init(&inner);
+        mini_init_array(&inner);
+        mini_move_value_to_array(&inner, &v);
+        if(i % 2) {
+            mini_value key;
+            mini_init(&key);
+            mini_set_string(&key, "k", 1);
+            mini_init_object(&v);
+            mini_move_value_to_object(&v, &key, &inner);
+        }
+        else
+            mini_move(&v, &inner);
+    }
+    mini_generate(&v, &json, &length);
+    EXPECT_EQ_SIZE_T(depth * 2 + depth / 2 * 6 + 1, length);
+    EXPECT_TRUE(memcmp(json, "{\"k\":[[{\"k\":[[", 14) == 0 && memcmp(json + length - 6, "]]}]]}", 6) == 0);
+    EXPECT_TRUE(strstr(json, "{\"k\":[[1]]}") != NULL);
+
+    /* copies walk the value as well, a copy into the value's own array included */
+    mini_init_array(&inner);
+    mini_add_value_to_array(&inner, &v);
+    mini_add_value_to_array(&inner, mini_get_array_element(&inner, 0));
+    mini_generate(mini_get_array_element(&inner, 1), &copy_json, &copy_length);
+    EXPECT_TRUE(copy_length == length && memcmp(json, copy_json, length) == 0);
+    free(copy_json);
+    mini_free(&inner);
+    free(json);
+    mini_free(&v);
+    EXPECT_EQ_INT(MINI_NULL, mini_get_type(&v));
+}
+
+/* one context for many texts: once its stack fits the largest, nothing is reallocated */
+static void test_context() {
+    static const char* const docs[] = {
+        "{ \"id\" : 1, \"tags\" : [ \"a\", \"b\\n\" ], \"o\" : { \"key longer than sixteen\" : null } }",
+        "[ 1, 2, 3 ]", "\"str\"", "[ 1, ", "{ \"a\" : [ { } ] }", "tru", "-1.5e+10"
+    };
+    static const mini_handler handler = {
+        test_sax_null, test_sax_boolean, test_sax_number, test_sax_string,
+        test_sax_start_object, test_sax_key, test_sax_end_object,
+        test_sax_start_array, test_sax_end_array
+    };
+    mini_context c;
+    test_sax_state sax;
+    test_sink_state st;
+    mini_value v, expect;
+    const char* text;
+    char* json, *stack;
+    size_t length, text_length, size, i, round;
+    mini_context_init(&c);
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_context_parse(&c, &v, docs[0]));
+    mini_free(&v);
+    stack = c.stack;
+    size = c.size;
+    for(round = 0; round < 3; round++) {
+        for(i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+            int ret;
+            mini_init(&expect);
+            ret = mini_parse(&expect, docs[i]);
+            EXPECT_EQ_INT(ret, mini_context_parse(&c, &v, docs[i]));
+            EXPECT_EQ_INT(ret, mini_context_parse_len(&c, &v, docs[i], strlen(docs[i])));
+            if(ret == MINI_PARSE_OK) {
+                mini_generate(&expect, &json, &length);
+                EXPECT_EQ_INT(MINI_GENERATE_OK, mini_context_generate(&c, &v, &text, &text_length));
+                EXPECT_TRUE(text_length == length && memcmp(text, json, length) == 0 && text[length] == '\0');
+                EXPECT_TRUE(text == c.stack);
+                memset(&st, 0, sizeof(st));
+                EXPECT_EQ_INT(MINI_GENERATE_OK, mini_context_generate_to(&c, &v, test_sink, &st));
+                EXPECT_TRUE(st.len == length && memcmp(st.buf, json, length) == 0);
+                free(st.buf);
+                free(json);
+            }
+            mini_free(&v);
+            mini_free(&expect);
+        }
+    }
+    EXPECT_TRUE(c.stack == stack && c.size == size);
+
+    memset(&sax, 0, sizeof(sax));
+    EXPECT_EQ_INT(MINI_PARSE_OK, mini_context_parse_sax(&c, "[ 1, { \"k\" : \"x\" } ]", &handler, &sax));
+    EXPECT_EQ_STRING("[i1{k:ks:x}1]2", sax.trace, sax.len);
+    EXPECT_EQ_INT(MINI_PARSE_MISS_COLON, mini_context_parse_sax(&c, "{ \"k\" 1 }", &handler, &sax));
+    EXPECT_TRUE(c.stack == stack && c.size == size);
+    mini_context_free(&c);
+    EXPECT_TRUE(c.stack == NULL);
+}
+
+static void test_interface() {
+    test_add_value_to_array();
+    test_add_value_to_object();
+    test_copy();
+    test_move_value();
+    test_array_capacity();
+    test_object_members();
+    test_alloc_sizes();
+    test_alloc_trim();
+    test_long_string();
+    test_thread_parse();
+    test_deep_value();
+    test_context();
+}
+
+int main() {
+    test_parse();
+    test_creater();
+    test_access();
+    test_interface();
+    printf("%d/%d (%3.2f%%) passed\n", test_pass, test_count, test_pass * 100.0 / test_count);
+    return main_ret;
+}